@@ -0,0 +1,454 @@
+#pragma once
+
+#include "geo/algorithm/intersection.hpp"
+#include "kit/debug/log.hpp"
+#include "kit/utility/type_constraints.hpp"
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+namespace kit
+{
+// dynamic aabb tree. as with the quad tree, this container does NOT own the elements and it is recommended to be used
+// with pointers or small trivial types. unlike the quad tree, each element is stored exactly once in a leaf, and leaves
+// hold a fattened version of the element's aabb so that small movements do not require a reinsertion. the tree is kept
+// balanced with local rotations on every insertion and removal
+
+// nodes are stored contiguously and referenced by index. the index of a leaf is its proxy, which stays valid until the
+// element is erased and can be used to update or erase it in logarithmic time
+template <typename T> class bvh
+{
+  public:
+    using proxy = std::uint32_t;
+    static inline constexpr proxy null = UINT32_MAX;
+
+    class node
+    {
+      public:
+        const geo::aabb2D &aabb() const
+        {
+            return m_aabb;
+        }
+        const T &element() const
+        {
+            KIT_ASSERT_ERROR(leaf(), "Can only access the element from a leaf node")
+            return m_element;
+        }
+
+        bool leaf() const
+        {
+            return m_children[0] == null;
+        }
+        proxy parent() const
+        {
+            return m_parent;
+        }
+        const std::array<proxy, 2> &children() const
+        {
+            KIT_ASSERT_ERROR(!leaf(), "Can only access children from a non-leaf node")
+            return m_children;
+        }
+        std::int32_t height() const
+        {
+            return m_height;
+        }
+
+      private:
+        geo::aabb2D m_aabb;
+        T m_element{};
+
+        // doubles as the next free node when the node is not in use
+        proxy m_parent = null;
+        std::array<proxy, 2> m_children = {null, null};
+
+        // leaves have height 0, free nodes have height -1
+        std::int32_t m_height = -1;
+
+        friend class bvh;
+    };
+
+    bvh(const float fat_margin = 0.1f) : m_fat_margin(fat_margin)
+    {
+    }
+
+    proxy insert(const T &element, const geo::aabb2D &aabb)
+    {
+        const proxy leaf = allocate_node();
+        node &n = m_nodes[leaf];
+        n.m_aabb = fatten(aabb);
+        n.m_element = element;
+        n.m_height = 0;
+
+        insert_leaf(leaf);
+        ++m_size;
+        return leaf;
+    }
+
+    void erase(const proxy leaf)
+    {
+        KIT_ASSERT_ERROR(leaf < m_nodes.size() && m_nodes[leaf].leaf() && m_nodes[leaf].m_height == 0,
+                         "Proxy {0} does not refer to a leaf of this tree", leaf)
+        remove_leaf(leaf);
+        deallocate_node(leaf);
+        --m_size;
+    }
+    bool erase(const T &element, const geo::aabb2D &aabb)
+    {
+        const proxy leaf = find(element, aabb);
+        if (leaf == null)
+            return false;
+        erase(leaf);
+        return true;
+    }
+    bool erase(const T &element)
+    {
+        const proxy leaf = find(element);
+        if (leaf == null)
+            return false;
+        erase(leaf);
+        return true;
+    }
+
+    // returns true if the leaf had to be reinserted because the new aabb escaped its fat aabb
+    bool update(const proxy leaf, const geo::aabb2D &aabb)
+    {
+        KIT_ASSERT_ERROR(leaf < m_nodes.size() && m_nodes[leaf].leaf() && m_nodes[leaf].m_height == 0,
+                         "Proxy {0} does not refer to a leaf of this tree", leaf)
+        if (contains(m_nodes[leaf].m_aabb, aabb))
+            return false;
+
+        remove_leaf(leaf);
+        m_nodes[leaf].m_aabb = fatten(aabb);
+        insert_leaf(leaf);
+        return true;
+    }
+
+    proxy find(const T &element, const geo::aabb2D &aabb) const
+    {
+        proxy result = null;
+        traverse_proxies(m_root, [this, &element, &result](const proxy leaf) {
+            if (m_nodes[leaf].m_element != element)
+                return true;
+            result = leaf;
+            return false;
+        }, aabb);
+        return result;
+    }
+    proxy find(const T &element) const
+    {
+        proxy result = null;
+        traverse_proxies(m_root, [this, &element, &result](const proxy leaf) {
+            if (m_nodes[leaf].m_element != element)
+                return true;
+            result = leaf;
+            return false;
+        });
+        return result;
+    }
+
+    void clear()
+    {
+        m_nodes.clear();
+        m_root = null;
+        m_free = null;
+        m_size = 0;
+    }
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    template <kit::RetCallable<bool, const T> F> void traverse(F &&fun) const
+    {
+        traverse_proxies(m_root, [this, &fun](const proxy leaf) { return fun(m_nodes[leaf].m_element); });
+    }
+    template <kit::RetCallable<bool, T> F> void traverse(F &&fun)
+    {
+        traverse_proxies(m_root, [this, &fun](const proxy leaf) { return fun(m_nodes[leaf].m_element); });
+    }
+
+    // leaves are tested against their fat aabb, so an element may be reported even if its tight aabb does not
+    // intersect the given one
+    template <kit::RetCallable<bool, const T> F> void traverse(F &&fun, const geo::aabb2D &aabb) const
+    {
+        traverse_proxies(
+            m_root, [this, &fun](const proxy leaf) { return fun(m_nodes[leaf].m_element); }, aabb);
+    }
+    template <kit::RetCallable<bool, T> F> void traverse(F &&fun, const geo::aabb2D &aabb)
+    {
+        traverse_proxies(
+            m_root, [this, &fun](const proxy leaf) { return fun(m_nodes[leaf].m_element); }, aabb);
+    }
+
+    const geo::aabb2D &aabb() const
+    {
+        KIT_ASSERT_ERROR(m_root != null, "Cannot get the aabb of an empty tree")
+        return m_nodes[m_root].m_aabb;
+    }
+    std::int32_t height() const
+    {
+        return m_root == null ? 0 : m_nodes[m_root].m_height;
+    }
+    float fat_margin() const
+    {
+        return m_fat_margin;
+    }
+
+    proxy root() const
+    {
+        return m_root;
+    }
+    const node &operator[](const proxy index) const
+    {
+        KIT_ASSERT_ERROR(index < m_nodes.size(), "Index exceeds container size: {0}", index)
+        return m_nodes[index];
+    }
+
+  private:
+    std::vector<node> m_nodes;
+    proxy m_root = null;
+    proxy m_free = null;
+    std::size_t m_size = 0;
+    float m_fat_margin;
+
+    template <typename F> bool traverse_proxies(const proxy index, F &&fun) const
+    {
+        if (index == null)
+            return true;
+        const node &n = m_nodes[index];
+        if (n.leaf())
+            return fun(index);
+        return traverse_proxies(n.m_children[0], fun) && traverse_proxies(n.m_children[1], fun);
+    }
+    template <typename F> bool traverse_proxies(const proxy index, F &&fun, const geo::aabb2D &aabb) const
+    {
+        if (index == null || !geo::intersects(m_nodes[index].m_aabb, aabb))
+            return true;
+        const node &n = m_nodes[index];
+        if (n.leaf())
+            return fun(index);
+        return traverse_proxies(n.m_children[0], fun, aabb) && traverse_proxies(n.m_children[1], fun, aabb);
+    }
+
+    proxy allocate_node()
+    {
+        if (m_free == null)
+        {
+            m_nodes.emplace_back();
+            return (proxy)(m_nodes.size() - 1);
+        }
+        const proxy index = m_free;
+        m_free = m_nodes[index].m_parent;
+        m_nodes[index] = node{};
+        return index;
+    }
+    void deallocate_node(const proxy index)
+    {
+        node &n = m_nodes[index];
+        n.m_parent = m_free;
+        n.m_children = {null, null};
+        n.m_height = -1;
+        m_free = index;
+    }
+
+    // the sibling is chosen by descending the tree with a perimeter based cost heuristic
+    void insert_leaf(const proxy leaf)
+    {
+        if (m_root == null)
+        {
+            m_root = leaf;
+            m_nodes[leaf].m_parent = null;
+            return;
+        }
+
+        const geo::aabb2D leaf_aabb = m_nodes[leaf].m_aabb;
+        proxy index = m_root;
+        while (!m_nodes[index].leaf())
+        {
+            const node &n = m_nodes[index];
+            const float combined_perimeter = perimeter(merge(n.m_aabb, leaf_aabb));
+
+            // cost of creating a new parent for this node and the new leaf, and the minimum cost of pushing the leaf
+            // further down the tree
+            const float cost = 2.f * combined_perimeter;
+            const float inheritance_cost = 2.f * (combined_perimeter - perimeter(n.m_aabb));
+
+            const float cost1 = descend_cost(n.m_children[0], leaf_aabb) + inheritance_cost;
+            const float cost2 = descend_cost(n.m_children[1], leaf_aabb) + inheritance_cost;
+            if (cost < cost1 && cost < cost2)
+                break;
+            index = cost1 < cost2 ? n.m_children[0] : n.m_children[1];
+        }
+
+        const proxy sibling = index;
+        const proxy old_parent = m_nodes[sibling].m_parent;
+        const proxy new_parent = allocate_node();
+        {
+            node &np = m_nodes[new_parent];
+            np.m_parent = old_parent;
+            np.m_aabb = merge(leaf_aabb, m_nodes[sibling].m_aabb);
+            np.m_height = m_nodes[sibling].m_height + 1;
+            np.m_children = {sibling, leaf};
+        }
+
+        if (old_parent != null)
+            replace_child(old_parent, sibling, new_parent);
+        else
+            m_root = new_parent;
+        m_nodes[sibling].m_parent = new_parent;
+        m_nodes[leaf].m_parent = new_parent;
+
+        refit(m_nodes[leaf].m_parent);
+    }
+
+    void remove_leaf(const proxy leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = null;
+            return;
+        }
+
+        const proxy parent = m_nodes[leaf].m_parent;
+        const proxy grand_parent = m_nodes[parent].m_parent;
+        const auto &siblings = m_nodes[parent].m_children;
+        const proxy sibling = siblings[0] == leaf ? siblings[1] : siblings[0];
+
+        if (grand_parent != null)
+        {
+            replace_child(grand_parent, parent, sibling);
+            m_nodes[sibling].m_parent = grand_parent;
+            deallocate_node(parent);
+            refit(grand_parent);
+        }
+        else
+        {
+            m_root = sibling;
+            m_nodes[sibling].m_parent = null;
+            deallocate_node(parent);
+        }
+        m_nodes[leaf].m_parent = null;
+    }
+
+    // walks up from the given node, rebalancing and recomputing heights and aabbs
+    void refit(proxy index)
+    {
+        while (index != null)
+        {
+            index = balance(index);
+            node &n = m_nodes[index];
+            const node &c1 = m_nodes[n.m_children[0]];
+            const node &c2 = m_nodes[n.m_children[1]];
+
+            n.m_height = 1 + std::max(c1.m_height, c2.m_height);
+            n.m_aabb = merge(c1.m_aabb, c2.m_aabb);
+            index = n.m_parent;
+        }
+    }
+
+    // performs a left or right rotation if the node is imbalanced. returns the new root of the subtree
+    proxy balance(const proxy ia)
+    {
+        node &a = m_nodes[ia];
+        if (a.leaf() || a.m_height < 2)
+            return ia;
+
+        const proxy ib = a.m_children[0];
+        const proxy ic = a.m_children[1];
+        node &b = m_nodes[ib];
+        node &c = m_nodes[ic];
+
+        const std::int32_t imbalance = c.m_height - b.m_height;
+        if (imbalance > 1)
+            return rotate(ia, ic, ib, 1);
+        if (imbalance < -1)
+            return rotate(ia, ib, ic, 0);
+        return ia;
+    }
+
+    // promotes the child 'up' of 'ia' (placed at 'side') to take its place. the taller grandchild stays under 'up' and
+    // the shorter one is handed to 'ia', replacing 'up'
+    proxy rotate(const proxy ia, const proxy iup, const proxy iother, const std::size_t side)
+    {
+        node &a = m_nodes[ia];
+        node &up = m_nodes[iup];
+
+        const proxy ig1 = up.m_children[0];
+        const proxy ig2 = up.m_children[1];
+        node &g1 = m_nodes[ig1];
+        node &g2 = m_nodes[ig2];
+
+        up.m_children[0] = ia;
+        up.m_parent = a.m_parent;
+        a.m_parent = iup;
+
+        if (up.m_parent != null)
+            replace_child(up.m_parent, ia, iup);
+        else
+            m_root = iup;
+
+        const bool keep_first = g1.m_height > g2.m_height;
+        const proxy ikeep = keep_first ? ig1 : ig2;
+        const proxy igive = keep_first ? ig2 : ig1;
+
+        up.m_children[1] = ikeep;
+        a.m_children[side] = igive;
+        m_nodes[igive].m_parent = ia;
+
+        const node &other = m_nodes[iother];
+        const node &keep = m_nodes[ikeep];
+        const node &give = m_nodes[igive];
+
+        a.m_aabb = merge(other.m_aabb, give.m_aabb);
+        a.m_height = 1 + std::max(other.m_height, give.m_height);
+        up.m_aabb = merge(a.m_aabb, keep.m_aabb);
+        up.m_height = 1 + std::max(a.m_height, keep.m_height);
+        return iup;
+    }
+
+    void replace_child(const proxy parent, const proxy old_child, const proxy new_child)
+    {
+        auto &children = m_nodes[parent].m_children;
+        if (children[0] == old_child)
+            children[0] = new_child;
+        else
+        {
+            KIT_ASSERT_ERROR(children[1] == old_child, "The node to replace must be a child of the parent")
+            children[1] = new_child;
+        }
+    }
+
+    float descend_cost(const proxy index, const geo::aabb2D &leaf_aabb) const
+    {
+        const node &n = m_nodes[index];
+        const float combined = perimeter(merge(n.m_aabb, leaf_aabb));
+        return n.leaf() ? combined : combined - perimeter(n.m_aabb);
+    }
+
+    geo::aabb2D fatten(const geo::aabb2D &aabb) const
+    {
+        const glm::vec2 margin{m_fat_margin};
+        return geo::aabb2D(aabb.min - margin, aabb.max + margin);
+    }
+
+    static geo::aabb2D merge(const geo::aabb2D &aabb1, const geo::aabb2D &aabb2)
+    {
+        return geo::aabb2D(glm::min(aabb1.min, aabb2.min), glm::max(aabb1.max, aabb2.max));
+    }
+    static float perimeter(const geo::aabb2D &aabb)
+    {
+        const glm::vec2 dim = aabb.max - aabb.min;
+        return 2.f * (dim.x + dim.y);
+    }
+    static bool contains(const geo::aabb2D &outer, const geo::aabb2D &inner)
+    {
+        return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.max.x >= inner.max.x &&
+               outer.max.y >= inner.max.y;
+    }
+};
+} // namespace kit
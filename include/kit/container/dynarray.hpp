@@ -5,9 +5,13 @@
 #include <initializer_list>
 #include <array>
 #include <algorithm>
+#include <memory>
+#include <type_traits>
 
 namespace kit
 {
+// elements live in uninitialized storage: only the first size() elements are constructed, and they are destroyed when
+// removed. if T is trivially copyable, so is the dynarray
 template <typename T, std::size_t Capacity> class dynarray
 {
   public:
@@ -20,23 +24,26 @@ template <typename T, std::size_t Capacity> class dynarray
     using const_reference = const value_type &;
     using pointer = value_type *;
     using const_pointer = const value_type *;
-    using iterator = typename std::array<value_type, Capacity>::iterator;
-    using const_iterator = typename std::array<value_type, Capacity>::const_iterator;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
     using reverse_iterator = std::reverse_iterator<iterator>;
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
     dynarray(const size_type size = 0) : m_size(size)
     {
+        KIT_ASSERT_ERROR(size <= Capacity, "Data size must not exceed capacity");
+        std::uninitialized_default_construct(begin(), end());
     }
     dynarray(const size_type size, const_reference value) : m_size(size)
     {
-        std::fill(begin(), end(), value);
+        KIT_ASSERT_ERROR(size <= Capacity, "Data size must not exceed capacity");
+        std::uninitialized_fill(begin(), end(), value);
     }
 
     template <std::input_iterator It> dynarray(It begin, It end) : m_size(std::distance(begin, end))
     {
         KIT_ASSERT_ERROR(m_size <= Capacity, "Data size must not exceed capacity");
-        std::copy(begin, end, m_data.begin());
+        std::uninitialized_copy(begin, end, data());
     }
 
     template <size_type OtherCapacity>
@@ -44,63 +51,152 @@ template <typename T, std::size_t Capacity> class dynarray
         requires(OtherCapacity <= Capacity)
         : m_size(data.size())
     {
-        std::copy(data.begin(), data.end(), m_data.begin());
+        std::uninitialized_copy(data.begin(), data.end(), begin());
     }
 
     dynarray(std::initializer_list<value_type> data) : m_size(data.size())
     {
         KIT_ASSERT_ERROR(data.size() <= Capacity, "Data size must not exceed capacity");
-        std::copy(data.begin(), data.end(), m_data.begin());
+        std::uninitialized_copy(data.begin(), data.end(), begin());
+    }
+
+    dynarray(const dynarray &other)
+        requires std::is_trivially_copyable_v<T>
+    = default;
+    dynarray(const dynarray &other) : m_size(other.m_size)
+    {
+        std::uninitialized_copy(other.begin(), other.end(), begin());
+    }
+
+    dynarray(dynarray &&other)
+        requires std::is_trivially_copyable_v<T>
+    = default;
+    dynarray(dynarray &&other) noexcept(std::is_nothrow_move_constructible_v<T>) : m_size(other.m_size)
+    {
+        std::uninitialized_move(other.begin(), other.end(), begin());
+    }
+
+    ~dynarray()
+        requires std::is_trivially_destructible_v<T>
+    = default;
+    ~dynarray()
+    {
+        std::destroy(begin(), end());
+    }
+
+    dynarray &operator=(const dynarray &other)
+        requires std::is_trivially_copyable_v<T>
+    = default;
+    dynarray &operator=(const dynarray &other)
+    {
+        if (this != &other)
+            assign(other.begin(), other.end());
+        return *this;
+    }
+
+    dynarray &operator=(dynarray &&other)
+        requires std::is_trivially_copyable_v<T>
+    = default;
+    dynarray &operator=(dynarray &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this == &other)
+            return *this;
+        clear();
+        std::uninitialized_move(other.begin(), other.end(), begin());
+        m_size = other.m_size;
+        return *this;
     }
 
     template <size_type OtherCapacity>
     dynarray &operator=(const dynarray<value_type, OtherCapacity> &data)
         requires(OtherCapacity <= Capacity)
     {
-        m_size = data.size();
-        std::copy(data.begin(), data.end(), m_data.begin());
+        assign(data.begin(), data.end());
         return *this;
     }
-    operator const std::array<value_type, Capacity> &() const
+
+    template <std::input_iterator It> void assign(It begin, It end)
     {
-        return m_data;
+        clear();
+        KIT_ASSERT_ERROR(std::distance(begin, end) <= (difference_type)Capacity, "Data size must not exceed capacity");
+        m_size = std::uninitialized_copy(begin, end, data()) - data();
     }
 
-    void push_back(const_reference elem)
+    template <class... Args> reference emplace_back(Args &&...args)
     {
         KIT_ASSERT_ERROR(m_size < Capacity, "Data size must not exceed capacity");
-        m_data[m_size++] = elem;
+        pointer ptr = std::construct_at(data() + m_size, std::forward<Args>(args)...);
+        ++m_size;
+        return *ptr;
     }
-    void insert(const_iterator pos, const_reference elem)
+    void push_back(const_reference elem)
     {
-        KIT_ASSERT_ERROR(m_size < Capacity, "Data size must not exceed capacity");
+        emplace_back(elem);
+    }
+    void push_back(value_type &&elem)
+    {
+        emplace_back(std::move(elem));
+    }
+
+    // the element is constructed at the end and rotated into place, so args may safely refer to elements of the array
+    template <class... Args> iterator emplace(const_iterator pos, Args &&...args)
+    {
+        KIT_ASSERT_ERROR(pos >= cbegin() && pos <= cend(), "Iterator must be within range");
         const difference_type offset = std::distance(cbegin(), pos);
-        std::copy_backward(begin() + offset, end(), end() + 1);
-        m_data[offset] = elem;
-        ++m_size;
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + offset, end() - 1, end());
+        return begin() + offset;
+    }
+    iterator insert(const_iterator pos, const_reference elem)
+    {
+        return emplace(pos, elem);
+    }
+    iterator insert(const_iterator pos, value_type &&elem)
+    {
+        return emplace(pos, std::move(elem));
     }
     void push_front(const_reference elem)
     {
         insert(begin(), elem);
     }
+    void push_front(value_type &&elem)
+    {
+        insert(begin(), std::move(elem));
+    }
 
     void pop_back()
     {
         KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
-        --m_size;
+        std::destroy_at(data() + --m_size);
     }
 
     void clear()
     {
+        std::destroy(begin(), end());
         m_size = 0;
     }
     bool empty() const
     {
         return m_size == 0;
     }
+
+    // new elements are default initialized, which leaves trivial types untouched
     void resize(const size_type size)
     {
         KIT_ASSERT_ERROR(size <= Capacity, "Data size must not exceed capacity");
+        if (size > m_size)
+            std::uninitialized_default_construct(end(), begin() + size);
+        else
+            std::destroy(begin() + size, end());
+        m_size = size;
+    }
+    void resize(const size_type size, const_reference value)
+    {
+        KIT_ASSERT_ERROR(size <= Capacity, "Data size must not exceed capacity");
+        if (size > m_size)
+            std::uninitialized_fill(end(), begin() + size, value);
+        else
+            std::destroy(begin() + size, end());
         m_size = size;
     }
     size_type size() const
@@ -119,121 +215,152 @@ template <typename T, std::size_t Capacity> class dynarray
 
     const_pointer data() const
     {
-        return m_data.data();
+        return reinterpret_cast<const_pointer>(m_data.data());
     }
     pointer data()
     {
-        return m_data.data();
+        return reinterpret_cast<pointer>(m_data.data());
     }
 
     reference front()
     {
         KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
-        return m_data[0];
+        return data()[0];
     }
     reference back()
     {
         KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
-        return m_data[m_size - 1];
+        return data()[m_size - 1];
     }
 
     const_reference front() const
     {
         KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
-        return m_data[0];
+        return data()[0];
     }
     const_reference back() const
     {
         KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
-        return m_data[m_size - 1];
+        return data()[m_size - 1];
     }
 
     iterator begin()
     {
-        return m_data.begin();
+        return data();
     }
     iterator end()
     {
-        return m_data.begin() + m_size;
+        return data() + m_size;
     }
     const_iterator begin() const
     {
-        return m_data.begin();
+        return data();
     }
     const_iterator end() const
     {
-        return m_data.begin() + m_size;
+        return data() + m_size;
     }
     const_iterator cbegin() const
     {
-        return m_data.cbegin();
+        return data();
     }
     const_iterator cend() const
     {
-        return m_data.cbegin() + m_size;
+        return data() + m_size;
+    }
+    reverse_iterator rbegin()
+    {
+        return reverse_iterator(end());
     }
-    reverse_iterator rbegin() const
+    reverse_iterator rend()
     {
-        return m_data.rbegin();
+        return reverse_iterator(begin());
     }
-    reverse_iterator rend() const
+    const_reverse_iterator rbegin() const
     {
-        return m_data.rbegin() + m_size;
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
     }
     const_reverse_iterator crbegin() const
     {
-        return m_data.crbegin();
+        return const_reverse_iterator(cend());
     }
     const_reverse_iterator crend() const
     {
-        return m_data.crbegin() + m_size;
+        return const_reverse_iterator(cbegin());
     }
 
     iterator erase(const_iterator pos)
     {
         KIT_ASSERT_ERROR(pos >= cbegin() && pos < cend(), "Iterator must be within range");
         const difference_type offset = std::distance(cbegin(), pos);
-        std::copy(pos + 1, cend(), begin() + offset);
-        --m_size;
+        std::move(begin() + offset + 1, end(), begin() + offset);
+        pop_back();
 
         return begin() + offset;
     }
     iterator erase(const_iterator first, const_iterator last)
     {
-        KIT_ASSERT_ERROR(first >= begin() && first <= end(), "Iterator must be within range");
-        KIT_ASSERT_ERROR(last >= begin() && last <= end(), "Iterator must be within range");
+        KIT_ASSERT_ERROR(first >= cbegin() && first <= cend(), "Iterator must be within range");
+        KIT_ASSERT_ERROR(last >= cbegin() && last <= cend(), "Iterator must be within range");
         KIT_ASSERT_ERROR(first <= last, "First iterator must be less than or equal to last iterator");
-        const difference_type offset = std::distance(begin(), first);
-        if (last != end())
-            std::copy(last, end(), first);
-        m_size -= std::distance(first, last);
+        const difference_type offset = std::distance(cbegin(), first);
+        const difference_type count = std::distance(first, last);
+        std::move(begin() + offset + count, end(), begin() + offset);
+        std::destroy(end() - count, end());
+        m_size -= count;
         return begin() + offset;
     }
 
+    // moves the last element into the erased position. O(1), but does not preserve the order of the elements
+    iterator erase_unordered(const_iterator pos)
+    {
+        KIT_ASSERT_ERROR(pos >= cbegin() && pos < cend(), "Iterator must be within range");
+        const iterator it = begin() + std::distance(cbegin(), pos);
+        if (it != end() - 1)
+            *it = std::move(back());
+        pop_back();
+        return it;
+    }
+
+    // removes all elements satisfying the predicate in a single pass, keeping the order of the rest. returns the
+    // amount of removed elements
+    template <kit::RetCallable<bool, const_reference> F> size_type erase_if(F &&pred)
+    {
+        const iterator last = std::remove_if(begin(), end(), std::forward<F>(pred));
+        const size_type count = std::distance(last, end());
+        std::destroy(last, end());
+        m_size -= count;
+        return count;
+    }
+
     reference operator[](const size_type index)
     {
         KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index);
-        return m_data[index];
+        return data()[index];
     }
     const_reference operator[](const size_type index) const
     {
         KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index);
-        return m_data[index];
+        return data()[index];
     }
 
     reference at(const size_type index)
     {
         KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index);
-        return m_data[index];
+        return data()[index];
     }
     const_reference at(const size_type index) const
     {
         KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index);
-        return m_data[index];
+        return data()[index];
     }
 
   private:
-    std::array<value_type, Capacity> m_data;
+    alignas(T) std::array<std::byte, sizeof(T) * Capacity> m_data;
     size_type m_size;
 };
-} // namespace kit
\ No newline at end of file
+} // namespace kit
@@ -0,0 +1,656 @@
+#pragma once
+
+#include "kit/debug/log.hpp"
+#include "kit/memory/allocator/allocator.hpp"
+#include "kit/utility/hash.hpp"
+#include "kit/utility/simd.hpp"
+#include <initializer_list>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <array>
+#include <algorithm>
+#include <tuple>
+#include <new>
+#include <bit>
+
+namespace kit
+{
+// one control byte per slot: empty, deleted or the 7 lower bits of the hash of the stored key. a group is 16
+// consecutive control bytes, which are compared against a hash all at once (sse2) or one by one (scalar fallback)
+class _flat_hash_group
+{
+  public:
+    static inline constexpr std::size_t WIDTH = 16;
+    static inline constexpr std::int8_t EMPTY = -128;
+    static inline constexpr std::int8_t DELETED = -2;
+
+#ifdef KIT_SSE2
+    _flat_hash_group(const std::int8_t *ctrl) : m_ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl)))
+    {
+    }
+
+    std::uint32_t match(const std::int8_t h2) const
+    {
+        return (std::uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_ctrl));
+    }
+    std::uint32_t match_empty() const
+    {
+        return match(EMPTY);
+    }
+    // empty and deleted are the only negative values below -1
+    std::uint32_t match_empty_or_deleted() const
+    {
+        return (std::uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), m_ctrl));
+    }
+    std::uint32_t match_full() const
+    {
+        return (std::uint32_t)_mm_movemask_epi8(m_ctrl) ^ 0xFFFF;
+    }
+
+  private:
+    __m128i m_ctrl;
+#else
+    _flat_hash_group(const std::int8_t *ctrl) : m_ctrl(ctrl)
+    {
+    }
+
+    std::uint32_t match(const std::int8_t h2) const
+    {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < WIDTH; i++)
+            mask |= (std::uint32_t)(m_ctrl[i] == h2) << i;
+        return mask;
+    }
+    std::uint32_t match_empty() const
+    {
+        return match(EMPTY);
+    }
+    std::uint32_t match_empty_or_deleted() const
+    {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < WIDTH; i++)
+            mask |= (std::uint32_t)(m_ctrl[i] < -1) << i;
+        return mask;
+    }
+    std::uint32_t match_full() const
+    {
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < WIDTH; i++)
+            mask |= (std::uint32_t)(m_ctrl[i] >= 0) << i;
+        return mask;
+    }
+
+  private:
+    const std::int8_t *m_ctrl;
+#endif
+};
+
+// open addressing hash table in the style of swiss tables: elements live directly in a flat slot array, and lookups
+// scan the control bytes a group at a time, so most misses never touch the slots. erased elements leave a tombstone
+// only when a probe could have walked past them. the result of the user hash is always mixed, so identity hashes
+// (integers, pointers) are fine. slots and control bytes share a single buffer, taken from the given allocator if there
+// is one (it must outlive the table), or from the global aligned new otherwise. as with any flat table, inserting may
+// move every element, invalidating iterators and references
+template <typename Key, typename Value, typename Hash, typename KeyEqual> class _flat_hash_table
+{
+    using group = _flat_hash_group;
+    static inline constexpr std::size_t WIDTH = group::WIDTH;
+    static inline constexpr bool IS_SET = std::is_same_v<Key, Value>;
+
+  public:
+    using key_type = Key;
+    using value_type = Value;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using key_equal = KeyEqual;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+
+    template <bool Const> class iterator_base
+    {
+        using table = std::conditional_t<Const, const _flat_hash_table, _flat_hash_table>;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = _flat_hash_table::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type *, value_type *>;
+        using reference = std::conditional_t<Const, const value_type &, value_type &>;
+
+        iterator_base() = default;
+
+        operator iterator_base<true>() const
+            requires(!Const)
+        {
+            return {m_table, m_index};
+        }
+
+        reference operator*() const
+        {
+            return m_table->m_slots[m_index];
+        }
+        pointer operator->() const
+        {
+            return m_table->m_slots + m_index;
+        }
+
+        iterator_base &operator++()
+        {
+            ++m_index;
+            skip_free();
+            return *this;
+        }
+        iterator_base operator++(int)
+        {
+            iterator_base it = *this;
+            ++(*this);
+            return it;
+        }
+
+        bool operator==(const iterator_base &other) const
+        {
+            return m_index == other.m_index;
+        }
+        bool operator!=(const iterator_base &other) const
+        {
+            return m_index != other.m_index;
+        }
+
+      private:
+        iterator_base(table *tbl, const size_type index) : m_table(tbl), m_index(index)
+        {
+        }
+
+        table *m_table = nullptr;
+        size_type m_index = 0;
+
+        void skip_free()
+        {
+            const size_type capacity = m_table->m_capacity;
+            while (m_index < capacity)
+            {
+                const std::uint32_t full = group(m_table->m_ctrl + m_index).match_full();
+                if (full)
+                {
+                    m_index = std::min(capacity, m_index + std::countr_zero(full));
+                    return;
+                }
+                m_index += WIDTH;
+            }
+            m_index = capacity;
+        }
+
+        template <bool> friend class iterator_base;
+        friend class _flat_hash_table;
+    };
+
+    // the elements of a set are its keys, so they cannot be modified through an iterator
+    using iterator = iterator_base<IS_SET>;
+    using const_iterator = iterator_base<true>;
+
+    _flat_hash_table(continuous_allocator<Value> *allocator = nullptr) : m_allocator(allocator)
+    {
+    }
+    _flat_hash_table(std::initializer_list<value_type> data, continuous_allocator<Value> *allocator = nullptr)
+        : m_allocator(allocator)
+    {
+        reserve(data.size());
+        for (const value_type &elem : data)
+            insert(elem);
+    }
+
+    // the copy uses the same allocator as the original
+    _flat_hash_table(const _flat_hash_table &other)
+        : m_allocator(other.m_allocator), m_hasher(other.m_hasher), m_equal(other.m_equal)
+    {
+        copy_from(other);
+    }
+    _flat_hash_table(_flat_hash_table &&other) noexcept
+        : m_ctrl(other.m_ctrl), m_slots(other.m_slots), m_size(other.m_size), m_capacity(other.m_capacity),
+          m_growth_left(other.m_growth_left), m_allocator(other.m_allocator), m_hasher(std::move(other.m_hasher)),
+          m_equal(std::move(other.m_equal))
+    {
+        other.release();
+    }
+
+    ~_flat_hash_table()
+    {
+        destroy_slots();
+        deallocate();
+    }
+
+    _flat_hash_table &operator=(const _flat_hash_table &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            m_hasher = other.m_hasher;
+            m_equal = other.m_equal;
+            copy_from(other);
+        }
+        return *this;
+    }
+    _flat_hash_table &operator=(_flat_hash_table &&other) noexcept
+    {
+        if (this == &other)
+            return *this;
+        destroy_slots();
+        deallocate();
+        m_ctrl = other.m_ctrl;
+        m_slots = other.m_slots;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        m_growth_left = other.m_growth_left;
+        m_allocator = other.m_allocator;
+        m_hasher = std::move(other.m_hasher);
+        m_equal = std::move(other.m_equal);
+        other.release();
+        return *this;
+    }
+
+    std::pair<iterator, bool> insert(const value_type &elem)
+    {
+        return emplace_with_key(key_of(elem), elem);
+    }
+    std::pair<iterator, bool> insert(value_type &&elem)
+    {
+        return emplace_with_key(key_of(elem), std::move(elem));
+    }
+    template <typename It> void insert(It begin, It end)
+    {
+        for (; begin != end; ++begin)
+            insert(*begin);
+    }
+
+    // the key is needed before knowing where the element goes, so the element is built up front
+    template <class... Args> std::pair<iterator, bool> emplace(Args &&...args)
+    {
+        value_type elem(std::forward<Args>(args)...);
+        return emplace_with_key(key_of(elem), std::move(elem));
+    }
+
+    iterator find(const key_type &key)
+    {
+        const size_type index = find_index(key, hash(key));
+        return {this, index == SIZE_MAX ? m_capacity : index};
+    }
+    const_iterator find(const key_type &key) const
+    {
+        const size_type index = find_index(key, hash(key));
+        return {this, index == SIZE_MAX ? m_capacity : index};
+    }
+    bool contains(const key_type &key) const
+    {
+        return find_index(key, hash(key)) != SIZE_MAX;
+    }
+    size_type count(const key_type &key) const
+    {
+        return contains(key) ? 1 : 0;
+    }
+
+    // returns an iterator to the next element. erasing never moves other elements
+    iterator erase(const const_iterator pos)
+    {
+        KIT_ASSERT_ERROR(pos.m_index < m_capacity, "Cannot erase the end iterator")
+        erase_at(pos.m_index);
+        iterator it{this, pos.m_index + 1};
+        it.skip_free();
+        return it;
+    }
+    size_type erase(const key_type &key)
+    {
+        const size_type index = find_index(key, hash(key));
+        if (index == SIZE_MAX)
+            return 0;
+        erase_at(index);
+        return 1;
+    }
+
+    // keeps the capacity
+    void clear()
+    {
+        destroy_slots();
+        if (m_capacity != 0)
+            std::memset(m_ctrl, group::EMPTY, m_capacity + WIDTH);
+        m_size = 0;
+        m_growth_left = max_load(m_capacity);
+    }
+
+    void reserve(const size_type size)
+    {
+        if (size <= max_load(m_capacity))
+            return;
+        size_type capacity = std::max(WIDTH, std::bit_ceil(size));
+        while (max_load(capacity) < size)
+            capacity *= 2;
+        rehash(capacity);
+    }
+
+    size_type size() const
+    {
+        return m_size;
+    }
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+    size_type capacity() const
+    {
+        return m_capacity;
+    }
+    float load_factor() const
+    {
+        return m_capacity == 0 ? 0.f : (float)m_size / (float)m_capacity;
+    }
+
+    continuous_allocator<Value> *allocator() const
+    {
+        return m_allocator;
+    }
+
+    iterator begin()
+    {
+        iterator it{this, 0};
+        it.skip_free();
+        return it;
+    }
+    iterator end()
+    {
+        return {this, m_capacity};
+    }
+    const_iterator begin() const
+    {
+        const_iterator it{this, 0};
+        it.skip_free();
+        return it;
+    }
+    const_iterator end() const
+    {
+        return {this, m_capacity};
+    }
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+  protected:
+    template <class... Args> std::pair<iterator, bool> emplace_with_key(const key_type &key, Args &&...args)
+    {
+        const std::uint64_t h = hash(key);
+        const size_type index = find_index(key, h);
+        if (index != SIZE_MAX)
+            return {iterator{this, index}, false};
+
+        const size_type slot = prepare_insert(h);
+        std::construct_at(m_slots + slot, std::forward<Args>(args)...);
+        return {iterator{this, slot}, true};
+    }
+
+  private:
+    // tables without capacity point to a static group of empty bytes, so lookups need no special case
+    static inline constexpr std::array<std::int8_t, WIDTH> EMPTY_GROUP = [] {
+        std::array<std::int8_t, WIDTH> ctrl;
+        ctrl.fill(group::EMPTY);
+        return ctrl;
+    }();
+
+    // the control array has WIDTH extra bytes at the end that mirror the first ones, so a group can be loaded starting
+    // from any slot without wrapping around
+    std::int8_t *m_ctrl = const_cast<std::int8_t *>(EMPTY_GROUP.data());
+    Value *m_slots = nullptr;
+    size_type m_size = 0;
+    size_type m_capacity = 0;
+    size_type m_growth_left = 0;
+
+    continuous_allocator<Value> *m_allocator;
+    [[no_unique_address]] Hash m_hasher{};
+    [[no_unique_address]] KeyEqual m_equal{};
+
+    static const key_type &key_of(const value_type &elem)
+    {
+        if constexpr (IS_SET)
+            return elem;
+        else
+            return elem.first;
+    }
+
+    std::uint64_t hash(const key_type &key) const
+    {
+        return hash_mix((std::uint64_t)m_hasher(key));
+    }
+    static std::int8_t h2(const std::uint64_t h)
+    {
+        return (std::int8_t)(h & 0x7F);
+    }
+    // zero for tables without capacity, so that probing stays within the static empty group
+    size_type mask() const
+    {
+        return m_capacity - (m_capacity != 0);
+    }
+
+    // 7/8 of the slots can be used before the table grows
+    static size_type max_load(const size_type capacity)
+    {
+        return capacity - capacity / 8;
+    }
+
+    // groups are probed triangularly, which visits every group of a power of two table
+    size_type find_index(const key_type &key, const std::uint64_t h) const
+    {
+        const std::int8_t tag = h2(h);
+        size_type pos = (size_type)(h >> 7) & mask();
+        for (size_type step = WIDTH;; pos = (pos + step) & mask(), step += WIDTH)
+        {
+            const group g(m_ctrl + pos);
+            for (std::uint32_t matches = g.match(tag); matches; matches &= matches - 1)
+            {
+                const size_type index = (pos + std::countr_zero(matches)) & mask();
+                if (m_equal(key_of(m_slots[index]), key))
+                    return index;
+            }
+            if (g.match_empty())
+                return SIZE_MAX;
+        }
+    }
+
+    size_type find_free(const std::uint64_t h) const
+    {
+        size_type pos = (size_type)(h >> 7) & mask();
+        for (size_type step = WIDTH;; pos = (pos + step) & mask(), step += WIDTH)
+        {
+            const std::uint32_t free = group(m_ctrl + pos).match_empty_or_deleted();
+            if (free)
+                return (pos + std::countr_zero(free)) & mask();
+        }
+    }
+
+    // claims a slot for a key that is known not to be in the table. the slot is left uninitialized
+    size_type prepare_insert(const std::uint64_t h)
+    {
+        size_type index = find_free(h);
+        if (m_growth_left == 0 && m_ctrl[index] != group::DELETED) [[unlikely]]
+        {
+            grow();
+            index = find_free(h);
+        }
+        m_growth_left -= m_ctrl[index] == group::EMPTY;
+        set_ctrl(index, h2(h));
+        ++m_size;
+        return index;
+    }
+
+    // if tombstones take up at least half of the usable slots, rebuilding at the same capacity is enough
+    void grow()
+    {
+        const size_type capacity = m_size >= max_load(m_capacity) / 2 ? 2 * m_capacity : m_capacity;
+        rehash(std::max(WIDTH, capacity));
+    }
+
+    void set_ctrl(const size_type index, const std::int8_t ctrl)
+    {
+        m_ctrl[index] = ctrl;
+        m_ctrl[((index - WIDTH) & mask()) + WIDTH] = ctrl;
+    }
+
+    // if there is an empty slot within every window of WIDTH slots containing the erased one, no probe ever went past
+    // it, and it can be marked as empty instead of deleted
+    void erase_at(const size_type index)
+    {
+        std::destroy_at(m_slots + index);
+        --m_size;
+        const std::uint32_t empty_after = group(m_ctrl + index).match_empty();
+        const std::uint32_t empty_before = group(m_ctrl + ((index - WIDTH) & mask())).match_empty();
+        const bool never_full = empty_after && empty_before &&
+                                (std::size_t)(std::countr_zero(empty_after) +
+                                              std::countl_zero((std::uint16_t)empty_before)) < WIDTH;
+        set_ctrl(index, never_full ? group::EMPTY : group::DELETED);
+        m_growth_left += never_full;
+    }
+
+    void rehash(const size_type capacity)
+    {
+        std::int8_t *old_ctrl = m_ctrl;
+        Value *old_slots = m_slots;
+        const size_type old_capacity = m_capacity;
+
+        allocate(capacity);
+        for (size_type i = 0; i < old_capacity; i++)
+            if (old_ctrl[i] >= 0)
+            {
+                const std::uint64_t h = hash(key_of(old_slots[i]));
+                const size_type index = find_free(h);
+                set_ctrl(index, h2(h));
+                std::construct_at(m_slots + index, std::move(old_slots[i]));
+                std::destroy_at(old_slots + i);
+            }
+        m_growth_left = max_load(m_capacity) - m_size;
+        deallocate(old_slots, old_capacity);
+    }
+
+    void copy_from(const _flat_hash_table &other)
+    {
+        reserve(other.m_size);
+        for (size_type i = 0; i < other.m_capacity; i++)
+            if (other.m_ctrl[i] >= 0)
+            {
+                const std::uint64_t h = hash(key_of(other.m_slots[i]));
+                std::construct_at(m_slots + prepare_insert(h), other.m_slots[i]);
+            }
+    }
+
+    void destroy_slots()
+    {
+        if constexpr (!std::is_trivially_destructible_v<Value>)
+            for (size_type i = 0; i < m_capacity; i++)
+                if (m_ctrl[i] >= 0)
+                    std::destroy_at(m_slots + i);
+    }
+
+    // the control bytes are placed right after the slots, in the same buffer
+    static size_type buffer_size(const size_type capacity)
+    {
+        return capacity + (capacity + WIDTH + sizeof(Value) - 1) / sizeof(Value);
+    }
+    void allocate(const size_type capacity)
+    {
+        const size_type size = buffer_size(capacity);
+        m_slots = m_allocator ? m_allocator->nallocate(size)
+                              : static_cast<Value *>(::operator new(size * sizeof(Value),
+                                                                    std::align_val_t{alignof(Value)}));
+        m_ctrl = reinterpret_cast<std::int8_t *>(m_slots + capacity);
+        m_capacity = capacity;
+        std::memset(m_ctrl, group::EMPTY, capacity + WIDTH);
+    }
+    void deallocate(Value *slots, const size_type capacity)
+    {
+        if (capacity == 0)
+            return;
+        if (m_allocator)
+            m_allocator->deallocate(slots);
+        else
+            ::operator delete(slots, buffer_size(capacity) * sizeof(Value), std::align_val_t{alignof(Value)});
+    }
+    void deallocate()
+    {
+        deallocate(m_slots, m_capacity);
+    }
+
+    // leaves a moved from table empty and without a buffer
+    void release()
+    {
+        m_ctrl = const_cast<std::int8_t *>(EMPTY_GROUP.data());
+        m_slots = nullptr;
+        m_size = 0;
+        m_capacity = 0;
+        m_growth_left = 0;
+    }
+};
+
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class flat_hash_map final : public _flat_hash_table<Key, std::pair<const Key, T>, Hash, KeyEqual>
+{
+    using base = _flat_hash_table<Key, std::pair<const Key, T>, Hash, KeyEqual>;
+
+  public:
+    using mapped_type = T;
+    using typename base::const_iterator;
+    using typename base::iterator;
+    using typename base::key_type;
+
+    using base::base;
+
+    // the value is only constructed if the key is not present
+    template <class... Args> std::pair<iterator, bool> try_emplace(const key_type &key, Args &&...args)
+    {
+        return this->emplace_with_key(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    template <class... Args> std::pair<iterator, bool> try_emplace(key_type &&key, Args &&...args)
+    {
+        return this->emplace_with_key(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                      std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    template <typename U> std::pair<iterator, bool> insert_or_assign(const key_type &key, U &&value)
+    {
+        const auto result = try_emplace(key, std::forward<U>(value));
+        if (!result.second)
+            result.first->second = std::forward<U>(value);
+        return result;
+    }
+
+    T &operator[](const key_type &key)
+    {
+        return try_emplace(key).first->second;
+    }
+    T &operator[](key_type &&key)
+    {
+        return try_emplace(std::move(key)).first->second;
+    }
+
+    T &at(const key_type &key)
+    {
+        const iterator it = this->find(key);
+        KIT_ASSERT_ERROR(it != this->end(), "Key not found")
+        return it->second;
+    }
+    const T &at(const key_type &key) const
+    {
+        const const_iterator it = this->find(key);
+        KIT_ASSERT_ERROR(it != this->end(), "Key not found")
+        return it->second;
+    }
+};
+
+template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+using flat_hash_set = _flat_hash_table<Key, Key, Hash, KeyEqual>;
+} // namespace kit
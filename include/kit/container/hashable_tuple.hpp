@@ -2,6 +2,7 @@
 
 #include "kit/utility/static_for_each.hpp"
 #include "kit/utility/type_constraints.hpp"
+#include "kit/utility/hash.hpp"
 #include <tuple>
 #include <functional>
 
@@ -60,23 +61,18 @@ template <hash_property Property, Hashable... HT> struct hashable_tuple
     }
 
   private:
-    inline static constexpr std::size_t SEED = 0x517cc1b7;
-    template <int... Ints> std::size_t operator()(std::integer_sequence<int, Ints...> int_seq) const
+    inline static constexpr std::uint64_t SEED = 0x517cc1b727220a95ull;
+    template <int... Ints> std::size_t operator()(std::integer_sequence<int, Ints...>) const
     {
-        std::size_t seed = SEED;
-        hash_combine(seed, std::get<Ints>(elms)...);
-        return seed;
-    }
-
-    template <typename T, class... Rest> static void hash_combine(std::size_t &seed, const T &hashable, Rest &&...rest)
-    {
-        const std::hash<T> hasher;
+        std::uint64_t seed = SEED;
         if constexpr (Property == hash_property::non_commutative)
-            seed ^= hasher(hashable) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            ((seed = hash_combine(seed, std::hash<HT>()(std::get<Ints>(elms)))), ...);
         else
-            seed ^= hasher(hashable) + 0x9e3779b9 + (SEED << 6) + (SEED >> 2);
-        if constexpr (sizeof...(rest) != 0)
-            hash_combine(seed, std::forward<Rest>(rest)...);
+        {
+            ((seed = hash_accumulate(seed, std::hash<HT>()(std::get<Ints>(elms)))), ...);
+            seed = hash_mix(seed);
+        }
+        return (std::size_t)seed;
     }
 
     template <typename T, typename U> static bool compare(const T &t, const U &u)
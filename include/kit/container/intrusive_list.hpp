@@ -0,0 +1,459 @@
+#pragma once
+
+#include "kit/utility/type_constraints.hpp"
+#include "kit/debug/log.hpp"
+#include <cstddef>
+#include <iterator>
+
+namespace kit
+{
+// intrusive lists do NOT own their elements. an element takes part in a list by inheriting from the corresponding hook.
+// the tag allows an element to be in several lists at once (one hook per tag). each hook remembers the list it is
+// linked into, so membership checks are O(1), and the lists use a sentinel node, so linking and unlinking never branch
+// on head or tail cases. copying an element does not copy its links, and an element must be erased from its list before
+// it is destroyed
+
+template <typename Tag = void> class list_hook
+{
+  public:
+    list_hook() = default;
+    list_hook(const list_hook &)
+    {
+    }
+    list_hook &operator=(const list_hook &)
+    {
+        return *this;
+    }
+
+    bool linked() const
+    {
+        return m_owner != nullptr;
+    }
+
+  private:
+    list_hook *m_next = nullptr;
+    list_hook *m_prev = nullptr;
+    const void *m_owner = nullptr;
+
+    template <typename, typename> friend class intrusive_list;
+};
+
+template <typename T, typename Tag = void>
+    requires DerivedFrom<T, list_hook<Tag>>
+class intrusive_list
+{
+    using hook = list_hook<Tag>;
+
+  public:
+    class iterator
+    {
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T *;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        T *operator->() const
+        {
+            return static_cast<T *>(m_hook);
+        }
+        T *operator*() const
+        {
+            return static_cast<T *>(m_hook);
+        }
+
+        iterator &operator++()
+        {
+            m_hook = m_hook->m_next;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            const iterator tmp = *this;
+            m_hook = m_hook->m_next;
+            return tmp;
+        }
+        iterator &operator--()
+        {
+            m_hook = m_hook->m_prev;
+            return *this;
+        }
+        iterator operator--(int)
+        {
+            const iterator tmp = *this;
+            m_hook = m_hook->m_prev;
+            return tmp;
+        }
+
+        bool operator==(const iterator &other) const
+        {
+            return m_hook == other.m_hook;
+        }
+        bool operator!=(const iterator &other) const
+        {
+            return m_hook != other.m_hook;
+        }
+
+      private:
+        iterator(hook *h) : m_hook(h)
+        {
+        }
+        hook *m_hook = nullptr;
+
+        friend class intrusive_list;
+    };
+
+    intrusive_list()
+    {
+        m_sentinel.m_next = &m_sentinel;
+        m_sentinel.m_prev = &m_sentinel;
+    }
+    ~intrusive_list()
+    {
+        clear();
+    }
+
+    intrusive_list(intrusive_list &&other) : intrusive_list()
+    {
+        splice(end(), other);
+    }
+    intrusive_list &operator=(intrusive_list &&other)
+    {
+        if (this != &other)
+        {
+            clear();
+            splice(end(), other);
+        }
+        return *this;
+    }
+
+    intrusive_list(const intrusive_list &) = delete;
+    intrusive_list &operator=(const intrusive_list &) = delete;
+
+    // inserts the element before pos and returns an iterator to it
+    iterator insert(const iterator pos, T *ptr)
+    {
+        hook *h = ptr;
+        KIT_ASSERT_ERROR(!h->linked(), "Cannot insert an element that is already linked")
+        KIT_ASSERT_ERROR(pos.m_hook == &m_sentinel || pos.m_hook->m_owner == this,
+                         "The position iterator must be in the list")
+        hook *next = pos.m_hook;
+        hook *prev = next->m_prev;
+        h->m_next = next;
+        h->m_prev = prev;
+        h->m_owner = this;
+        prev->m_next = h;
+        next->m_prev = h;
+        ++m_size;
+        return iterator(h);
+    }
+    void push_back(T *ptr)
+    {
+        insert(end(), ptr);
+    }
+    void push_front(T *ptr)
+    {
+        insert(begin(), ptr);
+    }
+
+    // returns an iterator to the element that followed the erased one
+    iterator erase(const iterator it)
+    {
+        hook *h = it.m_hook;
+        KIT_ASSERT_ERROR(h != &m_sentinel, "Cannot erase the end iterator")
+        KIT_ASSERT_ERROR(h->m_owner == this, "Cannot erase an element that is not in the list")
+        hook *next = h->m_next;
+        h->m_prev->m_next = next;
+        next->m_prev = h->m_prev;
+        h->m_next = nullptr;
+        h->m_prev = nullptr;
+        h->m_owner = nullptr;
+        --m_size;
+        return iterator(next);
+    }
+    iterator erase(T *ptr)
+    {
+        return erase(iterator(static_cast<hook *>(ptr)));
+    }
+
+    T *pop_back()
+    {
+        KIT_ASSERT_ERROR(!empty(), "Cannot pop from an empty list")
+        T *ptr = back();
+        erase(ptr);
+        return ptr;
+    }
+    T *pop_front()
+    {
+        KIT_ASSERT_ERROR(!empty(), "Cannot pop from an empty list")
+        T *ptr = front();
+        erase(ptr);
+        return ptr;
+    }
+
+    // moves every element of the other list before pos. the links are spliced in constant time, but each element has
+    // to be retagged with its new owner
+    void splice(const iterator pos, intrusive_list &other)
+    {
+        if (other.empty() || &other == this)
+            return;
+        for (hook *h = other.m_sentinel.m_next; h != &other.m_sentinel; h = h->m_next)
+            h->m_owner = this;
+
+        hook *first = other.m_sentinel.m_next;
+        hook *last = other.m_sentinel.m_prev;
+        hook *next = pos.m_hook;
+        hook *prev = next->m_prev;
+        prev->m_next = first;
+        first->m_prev = prev;
+        last->m_next = next;
+        next->m_prev = last;
+
+        m_size += other.m_size;
+        other.m_sentinel.m_next = &other.m_sentinel;
+        other.m_sentinel.m_prev = &other.m_sentinel;
+        other.m_size = 0;
+    }
+
+    bool contains(const T *ptr) const
+    {
+        return static_cast<const hook *>(ptr)->m_owner == this;
+    }
+    iterator iterator_to(T *ptr)
+    {
+        KIT_ASSERT_ERROR(contains(ptr), "The element is not in the list")
+        return iterator(static_cast<hook *>(ptr));
+    }
+
+    // unlinks every element
+    void clear()
+    {
+        hook *h = m_sentinel.m_next;
+        while (h != &m_sentinel)
+        {
+            hook *next = h->m_next;
+            h->m_next = nullptr;
+            h->m_prev = nullptr;
+            h->m_owner = nullptr;
+            h = next;
+        }
+        m_sentinel.m_next = &m_sentinel;
+        m_sentinel.m_prev = &m_sentinel;
+        m_size = 0;
+    }
+
+    T *front() const
+    {
+        KIT_ASSERT_ERROR(!empty(), "Cannot access the front of an empty list")
+        return static_cast<T *>(m_sentinel.m_next);
+    }
+    T *back() const
+    {
+        KIT_ASSERT_ERROR(!empty(), "Cannot access the back of an empty list")
+        return static_cast<T *>(m_sentinel.m_prev);
+    }
+
+    iterator begin() const
+    {
+        return iterator(m_sentinel.m_next);
+    }
+    iterator end() const
+    {
+        return iterator(const_cast<hook *>(&m_sentinel));
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+  private:
+    hook m_sentinel;
+    std::size_t m_size = 0;
+};
+
+// singly linked variant, for lists that are only pushed and popped from the front (free lists, work stacks...). each
+// hook only costs a next pointer and the owner tag
+template <typename Tag = void> class forward_list_hook
+{
+  public:
+    forward_list_hook() = default;
+    forward_list_hook(const forward_list_hook &)
+    {
+    }
+    forward_list_hook &operator=(const forward_list_hook &)
+    {
+        return *this;
+    }
+
+    bool linked() const
+    {
+        return m_owner != nullptr;
+    }
+
+  private:
+    forward_list_hook *m_next = nullptr;
+    const void *m_owner = nullptr;
+
+    template <typename, typename> friend class intrusive_forward_list;
+};
+
+template <typename T, typename Tag = void>
+    requires DerivedFrom<T, forward_list_hook<Tag>>
+class intrusive_forward_list
+{
+    using hook = forward_list_hook<Tag>;
+
+  public:
+    class iterator
+    {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T *;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        T *operator->() const
+        {
+            return static_cast<T *>(m_hook);
+        }
+        T *operator*() const
+        {
+            return static_cast<T *>(m_hook);
+        }
+
+        iterator &operator++()
+        {
+            m_hook = m_hook->m_next;
+            return *this;
+        }
+        iterator operator++(int)
+        {
+            const iterator tmp = *this;
+            m_hook = m_hook->m_next;
+            return tmp;
+        }
+
+        bool operator==(const iterator &other) const
+        {
+            return m_hook == other.m_hook;
+        }
+        bool operator!=(const iterator &other) const
+        {
+            return m_hook != other.m_hook;
+        }
+
+      private:
+        iterator(hook *h) : m_hook(h)
+        {
+        }
+        hook *m_hook = nullptr;
+
+        friend class intrusive_forward_list;
+    };
+
+    intrusive_forward_list() = default;
+    ~intrusive_forward_list()
+    {
+        clear();
+    }
+
+    intrusive_forward_list(const intrusive_forward_list &) = delete;
+    intrusive_forward_list &operator=(const intrusive_forward_list &) = delete;
+
+    void push_front(T *ptr)
+    {
+        hook *h = ptr;
+        KIT_ASSERT_ERROR(!h->linked(), "Cannot insert an element that is already linked")
+        h->m_next = m_sentinel.m_next;
+        h->m_owner = this;
+        m_sentinel.m_next = h;
+        ++m_size;
+    }
+    T *pop_front()
+    {
+        KIT_ASSERT_ERROR(!empty(), "Cannot pop from an empty list")
+        hook *h = m_sentinel.m_next;
+        m_sentinel.m_next = h->m_next;
+        h->m_next = nullptr;
+        h->m_owner = nullptr;
+        --m_size;
+        return static_cast<T *>(h);
+    }
+
+    // the before_begin iterator can be used to insert or erase at the front
+    void insert_after(const iterator pos, T *ptr)
+    {
+        hook *h = ptr;
+        KIT_ASSERT_ERROR(!h->linked(), "Cannot insert an element that is already linked")
+        KIT_ASSERT_ERROR(pos.m_hook == &m_sentinel || pos.m_hook->m_owner == this,
+                         "The position iterator must be in the list")
+        h->m_next = pos.m_hook->m_next;
+        h->m_owner = this;
+        pos.m_hook->m_next = h;
+        ++m_size;
+    }
+    // returns an iterator to the element that followed the erased one
+    iterator erase_after(const iterator pos)
+    {
+        KIT_ASSERT_ERROR(pos.m_hook == &m_sentinel || pos.m_hook->m_owner == this,
+                         "The position iterator must be in the list")
+        hook *h = pos.m_hook->m_next;
+        KIT_ASSERT_ERROR(h, "There is no element after the given position")
+        pos.m_hook->m_next = h->m_next;
+        h->m_next = nullptr;
+        h->m_owner = nullptr;
+        --m_size;
+        return iterator(pos.m_hook->m_next);
+    }
+
+    bool contains(const T *ptr) const
+    {
+        return static_cast<const hook *>(ptr)->m_owner == this;
+    }
+
+    void clear()
+    {
+        while (!empty())
+            pop_front();
+    }
+
+    T *front() const
+    {
+        KIT_ASSERT_ERROR(!empty(), "Cannot access the front of an empty list")
+        return static_cast<T *>(m_sentinel.m_next);
+    }
+
+    iterator before_begin() const
+    {
+        return iterator(const_cast<hook *>(&m_sentinel));
+    }
+    iterator begin() const
+    {
+        return iterator(m_sentinel.m_next);
+    }
+    iterator end() const
+    {
+        return iterator(nullptr);
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+  private:
+    hook m_sentinel;
+    std::size_t m_size = 0;
+};
+} // namespace kit
@@ -3,138 +3,520 @@
 #include "kit/debug/log.hpp"
 #include "kit/utility/type_constraints.hpp"
 #include <array>
+#include <span>
+#include <bit>
+#include <algorithm>
+#include <iterator>
 
 namespace kit
 {
-template <typename T, std::size_t Size> class _narray_impl
+// compile time description of a row major n dimensional shape
+template <std::size_t... Extents> struct narray_shape
 {
-  public:
-    template <class... ArrayArgs>
-        requires NoCopyCtorOverride<_narray_impl, ArrayArgs...>
-    _narray_impl(ArrayArgs &&...args) : m_data({std::forward<ArrayArgs>(args)...})
+    static inline constexpr std::size_t RANK = sizeof...(Extents);
+    static inline constexpr std::size_t SIZE = (Extents * ...);
+    static inline constexpr std::array<std::size_t, RANK> EXTENTS{Extents...};
+    static inline constexpr std::array<std::size_t, RANK> STRIDES = [] {
+        std::array<std::size_t, RANK> strides{};
+        std::size_t stride = 1;
+        for (std::size_t i = RANK; i-- > 0;)
+        {
+            strides[i] = stride;
+            stride *= EXTENTS[i];
+        }
+        return strides;
+    }();
+
+    template <std::integral... Indices>
+        requires(sizeof...(Indices) == RANK)
+    static constexpr std::size_t flat_index(const Indices... indices)
     {
+        const std::array<std::size_t, RANK> idx{(std::size_t)indices...};
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < RANK; i++)
+        {
+            KIT_ASSERT_ERROR(idx[i] < EXTENTS[i], "Index {0} exceeds extent {1} of dimension {2}", idx[i], EXTENTS[i],
+                             i)
+            index += idx[i] * STRIDES[i];
+        }
+        return index;
     }
-    const T &operator[](const std::size_t index) const noexcept
+};
+
+// layout policies map the coordinates of an element to its position in the buffer. all of them are bijections onto
+// [0, size), so no storage is wasted and flat iteration visits every element exactly once, in storage order
+
+// the last dimension is contiguous
+struct row_major
+{
+    template <std::size_t... Extents> static inline constexpr bool supports = true;
+
+    template <std::size_t... Extents>
+    static constexpr std::size_t offset(const std::array<std::size_t, sizeof...(Extents)> &idx)
     {
-        KIT_ASSERT_ERROR(index < m_data.size(), "Index exceeds container size: {0}", index)
-        return m_data[index];
+        using shape = narray_shape<Extents...>;
+        std::size_t offset = 0;
+        for (std::size_t i = 0; i < shape::RANK; i++)
+            offset += idx[i] * shape::STRIDES[i];
+        return offset;
     }
-    T &operator[](const std::size_t index) noexcept
+};
+
+// z order curve: the bits of the coordinates are interleaved, so elements close in every dimension are close in
+// memory. extents must be powers of two. once the smaller dimensions run out of bits, the larger ones keep going alone
+struct morton
+{
+    template <std::size_t... Extents> static inline constexpr bool supports = (std::has_single_bit(Extents) && ...);
+
+    template <std::size_t... Extents>
+    static constexpr std::size_t offset(const std::array<std::size_t, sizeof...(Extents)> &idx)
     {
-        KIT_ASSERT_ERROR(index < m_data.size(), "Index exceeds container size: {0}", index)
-        return m_data[index];
+        constexpr std::size_t rank = sizeof...(Extents);
+        constexpr std::array<std::size_t, rank> bits{(std::size_t)std::countr_zero(Extents)...};
+        constexpr std::size_t max_bits = std::max({(std::size_t)std::countr_zero(Extents)...});
+
+        std::size_t offset = 0;
+        std::size_t position = 0;
+        for (std::size_t b = 0; b < max_bits; b++)
+            for (std::size_t i = rank; i-- > 0;)
+                if (b < bits[i])
+                    offset |= ((idx[i] >> b) & 1) << position++;
+        return offset;
+    }
+};
+
+// the array is split in Tile^rank blocks, laid out in row major order, and each block is stored contiguously (and in
+// row major order as well). extents must be multiples of the tile size
+template <std::size_t Tile> struct tiled
+{
+    static_assert(Tile > 0, "Tile size must be greater than zero");
+    template <std::size_t... Extents> static inline constexpr bool supports = ((Extents % Tile == 0) && ...);
+
+    template <std::size_t... Extents>
+    static constexpr std::size_t offset(const std::array<std::size_t, sizeof...(Extents)> &idx)
+    {
+        constexpr std::size_t rank = sizeof...(Extents);
+        constexpr std::array<std::size_t, rank> tiles{(Extents / Tile)...};
+
+        std::size_t tile = 0;
+        std::size_t inner = 0;
+        for (std::size_t i = 0; i < rank; i++)
+        {
+            tile = tile * tiles[i] + idx[i] / Tile;
+            inner = inner * Tile + idx[i] % Tile;
+        }
+        std::size_t tile_size = 1;
+        for (std::size_t i = 0; i < rank; i++)
+            tile_size *= Tile;
+        return tile * tile_size + inner;
     }
+};
+
+template <typename T, typename Layout, std::size_t... Extents> class basic_narray_view;
+template <typename T, std::size_t Rank> class narray_slice;
+
+template <typename T, std::size_t... Extents> using narray_view = basic_narray_view<T, row_major, Extents...>;
 
-    const T &at(const std::size_t index) const
+// shared interface of arrays and views. everything is expressed in terms of the derived data() pointer, which is
+// contiguous, so flat iteration is a plain pointer loop over the storage order of the layout. sub array views and
+// slices rely on row major strides, so they are only available with that layout
+template <typename Derived, typename Layout, std::size_t First, std::size_t... Rest> class _narray_base
+{
+    static_assert(Layout::template supports<First, Rest...>, "The layout does not support the given extents");
+
+  public:
+    using shape = narray_shape<First, Rest...>;
+    using layout = Layout;
+    static inline constexpr bool ROW_MAJOR = std::is_same_v<Layout, row_major>;
+
+    static constexpr std::size_t rank() noexcept
     {
-        KIT_ASSERT_ERROR(index < m_data.size(), "Index exceeds container size: {0}", index)
-        return m_data.at(index);
+        return shape::RANK;
     }
-    T &at(const std::size_t index)
+    static constexpr std::size_t size() noexcept
     {
-        KIT_ASSERT_ERROR(index < m_data.size(), "Index exceeds container size: {0}", index)
-        return m_data.at(index);
+        return shape::SIZE;
+    }
+    static constexpr std::size_t extent(const std::size_t dimension) noexcept
+    {
+        return shape::EXTENTS[dimension];
+    }
+    // tiled layouts have no per dimension stride
+    static constexpr std::size_t stride(const std::size_t dimension) noexcept
+        requires ROW_MAJOR
+    {
+        return shape::STRIDES[dimension];
     }
 
-    const T *data() const noexcept
+    // returns an element for one dimensional arrays, and a view of the sub array otherwise
+    decltype(auto) operator[](const std::size_t index) noexcept
+        requires ROW_MAJOR
     {
-        return m_data.data();
+        return subscript(derived().data(), index);
     }
-    T *data() noexcept
+    decltype(auto) operator[](const std::size_t index) const noexcept
+        requires ROW_MAJOR
     {
-        return m_data.data();
+        return subscript(derived().data(), index);
+    }
+    decltype(auto) at(const std::size_t index)
+        requires ROW_MAJOR
+    {
+        return subscript(derived().data(), index);
+    }
+    decltype(auto) at(const std::size_t index) const
+        requires ROW_MAJOR
+    {
+        return subscript(derived().data(), index);
     }
 
-    const T &front() const noexcept
+    template <std::integral... Indices>
+        requires(sizeof...(Indices) == shape::RANK)
+    auto &operator()(const Indices... indices) noexcept
+    {
+        return derived().data()[offset(indices...)];
+    }
+    template <std::integral... Indices>
+        requires(sizeof...(Indices) == shape::RANK)
+    auto &operator()(const Indices... indices) const noexcept
     {
-        return m_data.front();
+        return derived().data()[offset(indices...)];
     }
-    const T &back() const noexcept
+
+    // position of the element in the buffer, according to the layout
+    template <std::integral... Indices>
+        requires(sizeof...(Indices) == shape::RANK)
+    static constexpr std::size_t offset(const Indices... indices)
     {
-        return m_data.back();
+        if constexpr (ROW_MAJOR)
+            return shape::flat_index(indices...);
+        else
+        {
+            const std::array<std::size_t, shape::RANK> idx{(std::size_t)indices...};
+            for (std::size_t i = 0; i < shape::RANK; i++)
+            {
+                KIT_ASSERT_ERROR(idx[i] < shape::EXTENTS[i], "Index {0} exceeds extent {1} of dimension {2}", idx[i],
+                                 shape::EXTENTS[i], i)
+            }
+            return Layout::template offset<First, Rest...>(idx);
+        }
     }
 
-    T &front() noexcept
+    // view of the array with one dimension fixed. the result is strided unless the fixed dimension is the first one
+    template <std::size_t Dimension>
+        requires(ROW_MAJOR && Dimension < sizeof...(Rest) + 1 && sizeof...(Rest) > 0)
+    auto slice(const std::size_t index) const
     {
-        return m_data.front();
+        return make_slice<Dimension>(derived().data(), index);
     }
-    T &back() noexcept
+    template <std::size_t Dimension>
+        requires(ROW_MAJOR && Dimension < sizeof...(Rest) + 1 && sizeof...(Rest) > 0)
+    auto slice(const std::size_t index)
     {
-        return m_data.back();
+        return make_slice<Dimension>(derived().data(), index);
     }
 
-    auto cbegin() const noexcept
+    auto flat() noexcept
     {
-        return m_data.cbegin();
+        return std::span<std::remove_reference_t<decltype(*derived().data())>, shape::SIZE>(derived().data(),
+                                                                                              shape::SIZE);
     }
-    auto cend() const noexcept
+    auto flat() const noexcept
     {
-        return m_data.cend();
+        return std::span<std::remove_reference_t<decltype(*derived().data())>, shape::SIZE>(derived().data(),
+                                                                                              shape::SIZE);
     }
 
-    auto begin() const noexcept
+    template <typename U> void fill(const U &value)
     {
-        return m_data.begin();
+        std::fill(begin(), end(), value);
     }
-    auto end() const noexcept
+
+    auto &front() noexcept
+    {
+        return *derived().data();
+    }
+    auto &back() noexcept
+    {
+        return derived().data()[shape::SIZE - 1];
+    }
+    auto &front() const noexcept
     {
-        return m_data.end();
+        return *derived().data();
+    }
+    auto &back() const noexcept
+    {
+        return derived().data()[shape::SIZE - 1];
     }
 
     auto begin() noexcept
     {
-        return m_data.begin();
+        return derived().data();
     }
     auto end() noexcept
     {
-        return m_data.end();
+        return derived().data() + shape::SIZE;
+    }
+    auto begin() const noexcept
+    {
+        return derived().data();
+    }
+    auto end() const noexcept
+    {
+        return derived().data() + shape::SIZE;
+    }
+    auto cbegin() const noexcept
+    {
+        return begin();
+    }
+    auto cend() const noexcept
+    {
+        return end();
     }
 
+    auto rbegin() noexcept
+    {
+        return std::reverse_iterator(end());
+    }
+    auto rend() noexcept
+    {
+        return std::reverse_iterator(begin());
+    }
     auto rbegin() const noexcept
     {
-        return m_data.rbegin();
+        return std::reverse_iterator(end());
     }
     auto rend() const noexcept
     {
-        return m_data.rend();
+        return std::reverse_iterator(begin());
     }
 
-    auto rbegin() noexcept
+  private:
+    Derived &derived() noexcept
     {
-        return m_data.rbegin();
+        return static_cast<Derived &>(*this);
     }
-    auto rend() noexcept
+    const Derived &derived() const noexcept
     {
-        return m_data.rend();
+        return static_cast<const Derived &>(*this);
     }
 
-    static constexpr std::size_t size() noexcept
+    template <typename T> static decltype(auto) subscript(T *data, const std::size_t index)
+    {
+        KIT_ASSERT_ERROR(index < First, "Index exceeds container size: {0}", index)
+        if constexpr (sizeof...(Rest) == 0)
+            return (data[index]);
+        else
+            return narray_view<T, Rest...>(data + index * shape::STRIDES[0]);
+    }
+
+    template <std::size_t Dimension, typename T> static auto make_slice(T *data, const std::size_t index)
+    {
+        KIT_ASSERT_ERROR(index < shape::EXTENTS[Dimension], "Index exceeds container size: {0}", index)
+        std::array<std::size_t, shape::RANK - 1> extents;
+        std::array<std::size_t, shape::RANK - 1> strides;
+        for (std::size_t i = 0, j = 0; i < shape::RANK; i++)
+            if (i != Dimension)
+            {
+                extents[j] = shape::EXTENTS[i];
+                strides[j++] = shape::STRIDES[i];
+            }
+        return narray_slice<T, shape::RANK - 1>(data + index * shape::STRIDES[Dimension], extents, strides);
+    }
+};
+
+// fixed size n dimensional array stored as a single contiguous buffer, ordered according to the layout (row major by
+// default). the buffer is aligned to Alignment, which can be raised to a cache line (see aligned_narray) so that rows
+// or tiles of suitable sizes never straddle two lines
+template <typename T, typename Layout, std::size_t Alignment, std::size_t... Extents>
+class basic_narray : public _narray_base<basic_narray<T, Layout, Alignment, Extents...>, Layout, Extents...>
+{
+    static_assert(sizeof...(Extents) > 0, "An narray must have at least one dimension");
+    static_assert(std::has_single_bit(Alignment) && Alignment >= alignof(T),
+                  "Alignment must be a power of two and at least the alignment of T");
+
+  public:
+    using value_type = T;
+    using shape = narray_shape<Extents...>;
+
+    // elements are value initialized, so arithmetic arrays start zeroed
+    basic_narray() = default;
+
+    // elements are given in storage order
+    template <class... Args>
+        requires(sizeof...(Args) > 0 && sizeof...(Args) <= shape::SIZE && (std::convertible_to<Args, T> && ...))
+    basic_narray(Args &&...args) : m_data{static_cast<T>(std::forward<Args>(args))...}
+    {
+    }
+
+    T *data() noexcept
+    {
+        return m_data.data();
+    }
+    const T *data() const noexcept
+    {
+        return m_data.data();
+    }
+
+    basic_narray_view<T, Layout, Extents...> view() noexcept
+    {
+        return basic_narray_view<T, Layout, Extents...>(data());
+    }
+    basic_narray_view<const T, Layout, Extents...> view() const noexcept
     {
-        return Size;
+        return basic_narray_view<const T, Layout, Extents...>(data());
+    }
+
+    // same elements seen with a different shape of the same size
+    template <std::size_t... NewExtents>
+        requires(std::is_same_v<Layout, row_major> && narray_shape<NewExtents...>::SIZE == shape::SIZE)
+    narray_view<T, NewExtents...> reshape() noexcept
+    {
+        return narray_view<T, NewExtents...>(data());
+    }
+    template <std::size_t... NewExtents>
+        requires(std::is_same_v<Layout, row_major> && narray_shape<NewExtents...>::SIZE == shape::SIZE)
+    narray_view<const T, NewExtents...> reshape() const noexcept
+    {
+        return narray_view<const T, NewExtents...>(data());
     }
 
   private:
-    std::array<T, Size> m_data;
+    alignas(Alignment) std::array<T, shape::SIZE> m_data{};
 };
 
 template <typename T, std::size_t Size, std::size_t... Shape>
-class narray : public _narray_impl<narray<T, Shape...>, Size>
+using narray = basic_narray<T, row_major, alignof(T), Size, Shape...>;
+
+template <typename T, std::size_t Alignment, std::size_t Size, std::size_t... Shape>
+using aligned_narray = basic_narray<T, row_major, Alignment, Size, Shape...>;
+
+// meant for 2D and 3D grids whose stencils read neighbours along every axis
+template <typename T, std::size_t Size, std::size_t... Shape>
+using morton_narray = basic_narray<T, morton, alignof(T), Size, Shape...>;
+
+template <typename T, std::size_t Tile, std::size_t Size, std::size_t... Shape>
+using tiled_narray = basic_narray<T, tiled<Tile>, alignof(T), Size, Shape...>;
+
+// non owning, contiguous view with the same interface as narray. like std::span, constness of the view does not
+// propagate to the elements: use narray_view<const T, ...> for read only access
+template <typename T, typename Layout, std::size_t... Extents>
+class basic_narray_view : public _narray_base<basic_narray_view<T, Layout, Extents...>, Layout, Extents...>
 {
   public:
-    template <class... ArrayArgs>
-        requires NoCopyCtorOverride<_narray_impl, ArrayArgs...>
-    narray(ArrayArgs &&...args) : _narray_impl<narray<T, Shape...>, Size>(std::forward<ArrayArgs>(args)...)
+    using value_type = std::remove_const_t<T>;
+    using shape = narray_shape<Extents...>;
+
+    explicit basic_narray_view(T *data) noexcept : m_data(data)
     {
     }
+    template <std::size_t Alignment>
+    basic_narray_view(basic_narray<value_type, Layout, Alignment, Extents...> &array) noexcept : m_data(array.data())
+    {
+    }
+    template <std::size_t Alignment>
+    basic_narray_view(const basic_narray<value_type, Layout, Alignment, Extents...> &array) noexcept
+        requires std::is_const_v<T>
+        : m_data(array.data())
+    {
+    }
+    basic_narray_view(const basic_narray_view<value_type, Layout, Extents...> &view) noexcept
+        requires std::is_const_v<T>
+        : m_data(view.data())
+    {
+    }
+
+    T *data() const noexcept
+    {
+        return m_data;
+    }
+
+  private:
+    T *m_data;
 };
 
-template <typename T, std::size_t Size> class narray<T, Size> : public _narray_impl<T, Size>
+// non owning view with runtime extents and strides, produced when fixing a dimension other than the first
+template <typename T, std::size_t Rank> class narray_slice
 {
   public:
-    template <class... ArrayArgs>
-        requires NoCopyCtorOverride<_narray_impl, ArrayArgs...>
-    narray(ArrayArgs &&...args) : _narray_impl<T, Size>(std::forward<ArrayArgs>(args)...)
+    narray_slice(T *data, const std::array<std::size_t, Rank> &extents, const std::array<std::size_t, Rank> &strides)
+        : m_data(data), m_extents(extents), m_strides(strides)
+    {
+    }
+
+    decltype(auto) operator[](const std::size_t index) const
+    {
+        KIT_ASSERT_ERROR(index < m_extents[0], "Index exceeds container size: {0}", index)
+        if constexpr (Rank == 1)
+            return (m_data[index * m_strides[0]]);
+        else
+        {
+            std::array<std::size_t, Rank - 1> extents;
+            std::array<std::size_t, Rank - 1> strides;
+            std::copy(m_extents.begin() + 1, m_extents.end(), extents.begin());
+            std::copy(m_strides.begin() + 1, m_strides.end(), strides.begin());
+            return narray_slice<T, Rank - 1>(m_data + index * m_strides[0], extents, strides);
+        }
+    }
+
+    template <std::integral... Indices>
+        requires(sizeof...(Indices) == Rank)
+    T &operator()(const Indices... indices) const
+    {
+        const std::array<std::size_t, Rank> idx{(std::size_t)indices...};
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < Rank; i++)
+        {
+            KIT_ASSERT_ERROR(idx[i] < m_extents[i], "Index {0} exceeds extent {1} of dimension {2}", idx[i],
+                             m_extents[i], i)
+            index += idx[i] * m_strides[i];
+        }
+        return m_data[index];
+    }
+
+    // visits every element in row major order
+    template <kit::Callable<T &> F> void for_each(F &&fun) const
+    {
+        for_each_impl<0>(m_data, fun);
+    }
+
+    static constexpr std::size_t rank() noexcept
+    {
+        return Rank;
+    }
+    std::size_t size() const noexcept
+    {
+        std::size_t size = 1;
+        for (const std::size_t extent : m_extents)
+            size *= extent;
+        return size;
+    }
+    std::size_t extent(const std::size_t dimension) const noexcept
+    {
+        return m_extents[dimension];
+    }
+    std::size_t stride(const std::size_t dimension) const noexcept
+    {
+        return m_strides[dimension];
+    }
+
+    T *data() const noexcept
+    {
+        return m_data;
+    }
+
+  private:
+    T *m_data;
+    std::array<std::size_t, Rank> m_extents;
+    std::array<std::size_t, Rank> m_strides;
+
+    template <std::size_t Dimension, typename F> void for_each_impl(T *data, F &fun) const
     {
+        for (std::size_t i = 0; i < m_extents[Dimension]; i++)
+            if constexpr (Dimension == Rank - 1)
+                fun(data[i * m_strides[Dimension]]);
+            else
+                for_each_impl<Dimension + 1>(data + i * m_strides[Dimension], fun);
     }
 };
-} // namespace kit
\ No newline at end of file
+} // namespace kit
@@ -5,20 +5,27 @@
 #include "kit/memory/allocator/block_allocator.hpp"
 #include "kit/utility/type_constraints.hpp"
 #include "kit/container/dynarray.hpp"
+#include "kit/container/small_vector.hpp"
+#include "kit/utility/simd.hpp"
 
 #include <vector>
 #include <array>
 #include <stack>
+#include <queue>
+#include <limits>
 
 namespace kit
 {
 // this container does NOT own the elements. it is recommended to be used with pointers or small trivial types
-// i have decided (for now) to use a fixed capacity array for the elements to improve locality, at some costs:
-// 1. the quad tree has a hard limit on the number of elements it can store, so no "max depth" is possible.
-// this CAN in some rare cases lead to a stack overflow, but it is very unlikely
-// 2. limits the quad tree to a fixed size, which is not ideal for all cases
-// 3. nodes can become very large, even when not used
-template <typename T, std::size_t MaxElems = 8, template <typename> class Allocator = block_allocator> class quad_tree
+// by default, leaves use a fixed capacity array for the elements to improve locality, at some costs:
+// 1. a full leaf must always subdivide, so no "max depth" is possible. this CAN in some rare cases (many elements
+// sharing the same point) lead to a stack overflow
+// 2. nodes can become very large, even when not used
+// a growable leaf container such as small_vector lifts the first limitation: leaves at the max depth simply grow past
+// MaxElems
+template <typename T, std::size_t MaxElems = 8, template <typename> class Allocator = block_allocator,
+          template <typename, std::size_t> class LeafContainer = dynarray>
+class quad_tree
 {
   public:
     struct entry
@@ -27,30 +34,90 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
         geo::aabb2D aabb;
     };
 
-    class node
+    using leaf_container = LeafContainer<entry, MaxElems>;
+
+    // fixed capacity containers (those exposing a CAPACITY constant, like dynarray) cannot hold more than MaxElems
+    static inline constexpr bool GROWABLE_LEAVES = !requires { leaf_container::CAPACITY; };
+
+    struct memory_usage
     {
-      public:
-        node() = default;
-        bool insert(const T &element, const geo::aabb2D &aabb)
+        std::size_t allocated_nodes;
+        std::size_t active_nodes;
+        std::size_t leaf_nodes;
+        std::size_t max_depth;
+        std::size_t node_size;
+
+        std::size_t allocated_bytes() const
         {
-            if (!geo::intersects(m_aabb, aabb))
-                return false;
-            if (m_leaf && m_elements.full())
-                subdivide();
+            return allocated_nodes * node_size;
+        }
+    };
 
-            if (m_leaf)
-                m_elements.push_back({element, aabb});
-            else
-                insert_into_children(element, aabb);
-            return true;
+    // four aabbs laid out as structure of arrays. intersects returns a bitmask with the i-th bit set if the i-th aabb
+    // intersects the given one
+    struct bounds4
+    {
+        alignas(16) std::array<float, 4> min_x;
+        alignas(16) std::array<float, 4> min_y;
+        alignas(16) std::array<float, 4> max_x;
+        alignas(16) std::array<float, 4> max_y;
+
+        void set(const std::size_t index, const geo::aabb2D &aabb)
+        {
+            min_x[index] = aabb.min.x;
+            min_y[index] = aabb.min.y;
+            max_x[index] = aabb.max.x;
+            max_y[index] = aabb.max.y;
         }
+
+        std::uint32_t intersects(const geo::aabb2D &aabb) const
+        {
+#ifdef KIT_SSE2
+            const __m128 x_overlap =
+                _mm_and_ps(_mm_cmple_ps(_mm_load_ps(min_x.data()), _mm_set1_ps(aabb.max.x)),
+                           _mm_cmpge_ps(_mm_load_ps(max_x.data()), _mm_set1_ps(aabb.min.x)));
+            const __m128 y_overlap =
+                _mm_and_ps(_mm_cmple_ps(_mm_load_ps(min_y.data()), _mm_set1_ps(aabb.max.y)),
+                           _mm_cmpge_ps(_mm_load_ps(max_y.data()), _mm_set1_ps(aabb.min.y)));
+            return (std::uint32_t)_mm_movemask_ps(_mm_and_ps(x_overlap, y_overlap));
+#else
+            std::uint32_t mask = 0;
+            for (std::size_t i = 0; i < 4; i++)
+                if (min_x[i] <= aabb.max.x && max_x[i] >= aabb.min.x && min_y[i] <= aabb.max.y &&
+                    max_y[i] >= aabb.min.y)
+                    mask |= 1u << i;
+            return mask;
+#endif
+        }
+    };
+
+    // a ray whose segment has been clipped to the tree bounds: it ends where it leaves the tree, or at max_t. a
+    // segment that is a single point (the ray only grazes a corner of the tree, for example) is reported by the first
+    // leaf visited
+    struct clipped_ray
+    {
+        glm::vec2 origin;
+        glm::vec2 dir;
+        glm::vec2 inv_dir;
+        float end;
+        glm::vec2 bounds_max;
+        bool point = false;
+    };
+
+    class node
+    {
+      public:
+        node() = default;
         // erase returns whether a merge was triggered
         bool erase(const T &element, const geo::aabb2D &aabb)
         {
             if (!m_leaf)
-                for (node *child : m_children)
-                    if (geo::intersects(child->m_aabb, aabb) && child->erase(element, aabb))
+            {
+                const std::uint32_t mask = m_child_bounds.intersects(aabb);
+                for (std::size_t i = 0; i < 4; i++)
+                    if ((mask & (1u << i)) && m_children[i]->erase(element, aabb))
                         break;
+            }
             return m_leaf && erase_as_leaf(element);
         }
         bool erase(const T &element)
@@ -65,7 +132,7 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
         template <kit::RetCallable<bool, const T> F> void traverse(F &&fun) const
         {
             if (m_leaf)
-                traverse_as_leaf<const entry, F>(std::forward<F>(fun));
+                traverse_as_leaf(*this, std::forward<F>(fun));
             else
                 for (node *child : m_children)
                     child->traverse(fun);
@@ -73,32 +140,63 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
         template <kit::RetCallable<bool, T> F> void traverse(F &&fun)
         {
             if (m_leaf)
-                traverse_as_leaf<entry, F>(std::forward<F>(fun));
+                traverse_as_leaf(*this, std::forward<F>(fun));
             else
                 for (node *child : m_children)
                     child->traverse(fun);
         }
 
+        // both children and leaf entries are box tested, so only elements whose aabb intersects the given one are
+        // passed to the callback
         template <kit::RetCallable<bool, const T> F> void traverse(F &&fun, const geo::aabb2D &aabb) const
         {
             if (m_leaf)
-                traverse_as_leaf<const entry, F>(std::forward<F>(fun));
+                traverse_as_leaf(*this, std::forward<F>(fun), aabb);
             else
-                for (node *child : m_children)
-                    if (geo::intersects(child->m_aabb, aabb))
-                        child->traverse(fun, aabb);
+            {
+                const std::uint32_t mask = m_child_bounds.intersects(aabb);
+                for (std::size_t i = 0; i < 4; i++)
+                    if (mask & (1u << i))
+                        m_children[i]->traverse(fun, aabb);
+            }
         }
         template <kit::RetCallable<bool, T> F> void traverse(F &&fun, const geo::aabb2D &aabb)
         {
             if (m_leaf)
-                traverse_as_leaf<entry, F>(std::forward<F>(fun));
+                traverse_as_leaf(*this, std::forward<F>(fun), aabb);
             else
-                for (node *child : m_children)
-                    if (geo::intersects(child->m_aabb, aabb))
-                        child->traverse(fun, aabb);
+            {
+                const std::uint32_t mask = m_child_bounds.intersects(aabb);
+                for (std::size_t i = 0; i < 4; i++)
+                    if (mask & (1u << i))
+                        m_children[i]->traverse(fun, aabb);
+            }
+        }
+
+        // returns false if the traversal was stopped by the callback
+        template <kit::RetCallable<bool, const T> F> bool raycast(clipped_ray &ray, F &&fun) const
+        {
+            if (m_leaf)
+                return raycast_as_leaf(ray, std::forward<F>(fun));
+
+            // children are visited front to back so that the callback can stop at the first relevant hit
+            dynarray<std::pair<float, const node *>, 4> hits;
+            for (const node *child : m_children)
+            {
+                float tmin, tmax;
+                if (ray_intersects(child->m_aabb, ray, tmin, tmax))
+                    hits.push_back({tmin, child});
+            }
+            for (std::size_t i = 1; i < hits.size(); i++) // at most 4 elements, insertion sort is enough
+                for (std::size_t j = i; j > 0 && hits[j - 1].first > hits[j].first; j--)
+                    std::swap(hits[j - 1], hits[j]);
+            for (const auto &[t, child] : hits)
+                if (!child->raycast(ray, fun))
+                    return false;
+            return true;
         }
 
-        const kit::dynarray<entry, MaxElems> &elements() const
+        const leaf_container &elements() const
         {
             KIT_ASSERT_ERROR(m_leaf, "Can only access elements from a leaf node")
             return m_elements;
@@ -119,36 +217,102 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
         }
 
       private:
+        // nodes are taken from the tree's allocator, which has to be passed down on every insertion
+        bool insert(const T &element, const geo::aabb2D &aabb, Allocator<node> &allocator,
+                    const std::uint32_t max_depth)
+        {
+            if (!geo::intersects(m_aabb, aabb))
+                return false;
+            if (m_leaf && m_elements.size() >= MaxElems && m_depth < max_depth)
+                subdivide(allocator, max_depth);
+
+            if (m_leaf)
+                m_elements.push_back({element, aabb});
+            else
+                insert_into_children(element, aabb, allocator, max_depth);
+            return true;
+        }
+
         bool erase_as_leaf(const T &element)
         {
             for (auto it = m_elements.begin(); it != m_elements.end(); ++it)
                 if (it->element == element)
                 {
-                    m_elements.erase(it);
+                    m_elements.erase_unordered(it);
                     return m_parent && m_elements.size() <= MaxElems / 4 && m_parent->try_merge();
                 }
             return false;
         }
 
-        template <typename U, kit::RetCallable<bool, T> F> void traverse_as_leaf(F &&fun)
+        // self is templated so that the const and non const traversals share the same code
+        template <typename Self, typename F> static void traverse_as_leaf(Self &self, F &&fun)
         {
-            for (U &entry : m_elements)
+            for (auto &entry : self.m_elements)
                 if (!std::forward<F>(fun)(entry.element))
                     return;
         }
+        // leaf entries are stored as element and aabb pairs, so a plain test reads them where they are. gathering them
+        // into a bounds4 block to test four at once costs more stores than it saves compares
+        template <typename Self, typename F>
+        static void traverse_as_leaf(Self &self, F &&fun, const geo::aabb2D &aabb)
+        {
+            for (auto &entry : self.m_elements)
+                if (entry.aabb.min.x <= aabb.max.x && entry.aabb.max.x >= aabb.min.x &&
+                    entry.aabb.min.y <= aabb.max.y && entry.aabb.max.y >= aabb.min.y &&
+                    !std::forward<F>(fun)(entry.element))
+                    return;
+        }
 
-        void subdivide()
+        template <kit::RetCallable<bool, const T> F> bool raycast_as_leaf(clipped_ray &ray, F &&fun) const
+        {
+            float enter, exit;
+            if (!ray_intersects(m_aabb, ray, enter, exit))
+                return true;
+
+            // a ray parallel to an axis that runs along a split line touches the leaves on both sides of it. only the
+            // one past the line reports elements, unless the line is the border of the tree
+            for (int axis = 0; axis < 2; axis++)
+                if (ray.dir[axis] == 0.f && ray.origin[axis] == m_aabb.max[axis] &&
+                    m_aabb.max[axis] < ray.bounds_max[axis])
+                    return true;
+
+            // an element is only reported by the leaf where the ray enters its aabb. this keeps the order exact across
+            // leaves and avoids reporting elements that span several of them more than once. the range is half open,
+            // so that an element entered right on the border of two leaves is reported by the second one, except in
+            // the leaf where the ray ends. leaves the ray only touches at a single point report nothing
+            bool last = exit >= ray.end && enter < exit;
+            if (ray.point)
+            {
+                last = true;
+                ray.point = false;
+            }
+            LeafContainer<std::pair<float, const entry *>, MaxElems> hits;
+            for (const entry &e : m_elements)
+            {
+                float tmin, tmax;
+                if (ray_intersects(e.aabb, ray, tmin, tmax) && tmin >= enter && (tmin < exit || last))
+                    hits.push_back({tmin, &e});
+            }
+            std::sort(hits.begin(), hits.end(), [](const auto &h1, const auto &h2) { return h1.first < h2.first; });
+            for (const auto &[t, e] : hits)
+                if (!std::forward<F>(fun)(e->element))
+                    return false;
+            return true;
+        }
+
+        void subdivide(Allocator<node> &allocator, const std::uint32_t max_depth)
         {
             m_leaf = false;
             if (!m_children[0])
                 for (std::size_t i = 0; i < 4; ++i)
-                    m_children[i] = s_allocator.create();
+                    m_children[i] = allocator.create();
 
             for (node *c : m_children)
             {
                 c->m_leaf = true;
                 c->m_elements.clear();
                 c->m_parent = this;
+                c->m_depth = m_depth + 1;
             }
 
             const glm::vec2 &mm = m_aabb.min;
@@ -160,8 +324,10 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
             m_children[1]->m_aabb = geo::aabb2D(mid_point, mx);
             m_children[2]->m_aabb = geo::aabb2D(mm, mid_point);
             m_children[3]->m_aabb = geo::aabb2D(glm::vec2(mid_point.x, mm.y), glm::vec2(mx.x, mid_point.y));
+            for (std::size_t i = 0; i < 4; i++)
+                m_child_bounds.set(i, m_children[i]->m_aabb);
             for (const entry &e : m_elements)
-                insert_into_children(e.element, e.aabb);
+                insert_into_children(e.element, e.aabb, allocator, max_depth);
             m_elements.clear();
         }
 
@@ -194,17 +360,48 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
             return true;
         }
 
-        void insert_into_children(const T &element, const geo::aabb2D &aabb)
+        void insert_into_children(const T &element, const geo::aabb2D &aabb, Allocator<node> &allocator,
+                                  const std::uint32_t max_depth)
         {
             for (node *child : m_children)
-                child->insert(element, aabb);
+                child->insert(element, aabb, allocator, max_depth);
+        }
+
+        // merged nodes keep their children around to be reused in later subdivisions, so those are released too
+        void release(Allocator<node> &allocator)
+        {
+            if (!m_children[0])
+                return;
+            for (node *&child : m_children)
+            {
+                child->release(allocator);
+                allocator.destroy(child);
+                child = nullptr;
+            }
+        }
+
+        void measure(memory_usage &usage, const bool active) const
+        {
+            usage.active_nodes += active;
+            usage.leaf_nodes += active && m_leaf;
+            if (active)
+                usage.max_depth = std::max(usage.max_depth, (std::size_t)m_depth);
+            if (!m_children[0])
+                return;
+
+            usage.allocated_nodes += 4;
+            for (const node *child : m_children)
+                child->measure(usage, active && !m_leaf);
         }
 
-        dynarray<entry, MaxElems> m_elements;
+        leaf_container m_elements;
 
         node *m_parent = nullptr;
         std::array<node *, 4> m_children = {nullptr, nullptr, nullptr, nullptr};
 
+        // children aabbs stored as structure of arrays so that all four can be tested at once
+        bounds4 m_child_bounds;
+
         geo::aabb2D m_aabb;
 
         std::uint32_t m_depth = 0;
@@ -215,14 +412,46 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
 
     quad_tree() = default;
 
-    quad_tree &operator=(quad_tree &&) = default;
-    quad_tree(quad_tree &&) = default;
+    // the allocator arguments are forwarded to the allocator constructor (for example, the block object count of a
+    // block allocator). each tree owns its allocator, so different trees can be safely used from different threads
+    template <class... AllocatorArgs>
+    quad_tree(const geo::aabb2D &aabb, AllocatorArgs &&...args) : m_allocator(std::forward<AllocatorArgs>(args)...)
+    {
+        m_root.m_aabb = aabb;
+    }
+
+    ~quad_tree()
+    {
+        m_root.release(m_allocator);
+    }
+
+    quad_tree(quad_tree &&other)
+        : m_root(std::move(other.m_root)), m_allocator(std::move(other.m_allocator)), m_max_depth(other.m_max_depth)
+    {
+        adopt_root_children();
+        other.m_root.m_children = {nullptr, nullptr, nullptr, nullptr};
+        other.clear();
+    }
+    quad_tree &operator=(quad_tree &&other)
+    {
+        if (this == &other)
+            return *this;
+        m_root.release(m_allocator);
+        m_root = std::move(other.m_root);
+        m_allocator = std::move(other.m_allocator);
+        m_max_depth = other.m_max_depth;
+
+        adopt_root_children();
+        other.m_root.m_children = {nullptr, nullptr, nullptr, nullptr};
+        other.clear();
+        return *this;
+    }
 
     bool insert(const T &element, const geo::aabb2D &aabb)
     {
         KIT_ASSERT_WARN(geo::intersects(m_root.m_aabb, aabb),
                         "Element aabb does not intersect with the quad tree bounds")
-        return m_root.insert(element, aabb);
+        return m_root.insert(element, aabb, m_allocator, m_max_depth);
     }
     void erase(const T &element, const geo::aabb2D &aabb)
     {
@@ -235,8 +464,10 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
         m_root.erase(element);
     }
 
+    // every node is returned to the allocator
     void clear()
     {
+        m_root.release(m_allocator);
         m_root.m_elements.clear();
         m_root.m_leaf = true;
     }
@@ -267,6 +498,86 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
         m_root.traverse(fun, aabb);
     }
 
+    // the ray is defined as origin + t * dir, with t in [0, max_t]. elements whose aabb is hit are passed to the
+    // callback sorted by the distance at which the ray enters them, and returning false from it stops the query. each
+    // element is reported once, even if it touches several leaves
+    template <kit::RetCallable<bool, const T> F>
+    void raycast(const glm::vec2 &origin, const glm::vec2 &dir, const float max_t, F &&fun) const
+    {
+        clipped_ray ray{origin, dir, 1.f / dir, max_t, m_root.m_aabb.max};
+        float enter, exit;
+        if (!ray_intersects(m_root.m_aabb, ray, enter, exit))
+            return;
+        ray.end = exit;
+        ray.point = enter == exit;
+        m_root.raycast(ray, std::forward<F>(fun));
+    }
+
+    // best first search of the k elements whose aabb is closest to the given point, sorted by increasing distance.
+    // nodes further away than the current k-th candidate are never visited
+    std::vector<T> nearest(const glm::vec2 &point, const std::size_t k = 1) const
+    {
+        KIT_ASSERT_ERROR(k > 0, "The amount of nearest elements to query must be greater than zero")
+        using node_candidate = std::pair<float, const node *>;
+        using entry_candidate = std::pair<float, const entry *>;
+
+        const auto farther = [](const auto &c1, const auto &c2) { return c1.first > c2.first; };
+        const auto closer = [](const auto &c1, const auto &c2) { return c1.first < c2.first; };
+
+        std::priority_queue<node_candidate, std::vector<node_candidate>, decltype(farther)> to_visit{farther};
+
+        // bounded max heap: the front is the worst of the current k candidates
+        std::vector<entry_candidate> best;
+        best.reserve(k + 1);
+        const auto worst_distance = [&best, k]() {
+            return best.size() < k ? std::numeric_limits<float>::max() : best.front().first;
+        };
+
+        to_visit.emplace(sq_distance(m_root.m_aabb, point), &m_root);
+        while (!to_visit.empty())
+        {
+            const auto [distance, current] = to_visit.top();
+            to_visit.pop();
+            if (distance >= worst_distance())
+                break;
+
+            if (!current->m_leaf)
+            {
+                for (const node *child : current->m_children)
+                {
+                    const float child_distance = sq_distance(child->m_aabb, point);
+                    if (child_distance < worst_distance())
+                        to_visit.emplace(child_distance, child);
+                }
+                continue;
+            }
+            for (const entry &e : current->m_elements)
+            {
+                const float entry_distance = sq_distance(e.aabb, point);
+                if (entry_distance >= worst_distance() ||
+                    std::any_of(best.begin(), best.end(), [&e](const entry_candidate &c) {
+                        return c.second->element == e.element;
+                    })) // elements may be duplicated across leaves
+                    continue;
+
+                best.emplace_back(entry_distance, &e);
+                std::push_heap(best.begin(), best.end(), closer);
+                if (best.size() > k)
+                {
+                    std::pop_heap(best.begin(), best.end(), closer);
+                    best.pop_back();
+                }
+            }
+        }
+
+        std::sort_heap(best.begin(), best.end(), closer);
+        std::vector<T> result;
+        result.reserve(best.size());
+        for (const entry_candidate &c : best)
+            result.push_back(c.second->element);
+        return result;
+    }
+
     const geo::aabb2D &aabb() const
     {
         return m_root.m_aabb;
@@ -282,12 +593,73 @@ template <typename T, std::size_t MaxElems = 8, template <typename> class Alloca
         return m_root;
     }
 
+    std::uint32_t max_depth() const
+    {
+        return m_max_depth;
+    }
+    // leaves at the max depth no longer subdivide, so this is only available with growable leaves. it does not affect
+    // nodes that are already deeper
+    void max_depth(const std::uint32_t max_depth)
+        requires GROWABLE_LEAVES
+    {
+        m_max_depth = max_depth;
+    }
+
+    // the root lives inside the tree and is not counted as allocated. allocated nodes that are not active are the
+    // children of merged leaves, which are kept for later subdivisions until the tree is cleared
+    memory_usage memory() const
+    {
+        memory_usage usage{};
+        usage.node_size = sizeof(node);
+        m_root.measure(usage, true);
+        return usage;
+    }
+
   private:
     node m_root;
 
     quad_tree(const quad_tree &) = delete;
     quad_tree &operator=(const quad_tree &) = delete;
 
-    static inline Allocator<node> s_allocator{};
+    Allocator<node> m_allocator{};
+    std::uint32_t m_max_depth = GROWABLE_LEAVES ? 12 : std::numeric_limits<std::uint32_t>::max();
+
+    void adopt_root_children()
+    {
+        if (m_root.m_children[0])
+            for (node *child : m_root.m_children)
+                child->m_parent = &m_root;
+    }
+
+    // slab test. tmin and tmax are clamped to the [0, end] segment of the ray. axes the ray is parallel to are tested
+    // directly against the origin, as the infinite inverse direction would give nan when the origin lies on a slab
+    static bool ray_intersects(const geo::aabb2D &aabb, const clipped_ray &ray, float &tmin, float &tmax)
+    {
+        tmin = 0.f;
+        tmax = ray.end;
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if (ray.dir[axis] == 0.f)
+            {
+                if (ray.origin[axis] < aabb.min[axis] || ray.origin[axis] > aabb.max[axis])
+                    return false;
+                continue;
+            }
+            float t1 = (aabb.min[axis] - ray.origin[axis]) * ray.inv_dir[axis];
+            float t2 = (aabb.max[axis] - ray.origin[axis]) * ray.inv_dir[axis];
+            if (t1 > t2)
+                std::swap(t1, t2);
+            tmin = std::max(tmin, t1);
+            tmax = std::min(tmax, t2);
+        }
+        return tmin <= tmax;
+    }
+
+    static float sq_distance(const geo::aabb2D &aabb, const glm::vec2 &point)
+    {
+        const float dx = std::max(std::max(aabb.min.x - point.x, point.x - aabb.max.x), 0.f);
+        const float dy = std::max(std::max(aabb.min.y - point.y, point.y - aabb.max.y), 0.f);
+        return dx * dx + dy * dy;
+    }
 };
 } // namespace kit
\ No newline at end of file
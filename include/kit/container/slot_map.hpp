@@ -0,0 +1,238 @@
+#pragma once
+
+#include "kit/debug/log.hpp"
+#include "kit/utility/hash.hpp"
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace kit
+{
+// a handle stays valid until its element is erased. slots are reused, but each reuse bumps the slot generation, so
+// stale handles to an erased element are detected instead of silently pointing to a newer one
+struct slot_handle
+{
+    static inline constexpr std::uint32_t NULL_INDEX = UINT32_MAX;
+
+    std::uint32_t index = NULL_INDEX;
+    std::uint32_t generation = 0;
+
+    bool null() const
+    {
+        return index == NULL_INDEX;
+    }
+    operator std::uint64_t() const
+    {
+        return ((std::uint64_t)generation << 32) | index;
+    }
+};
+
+inline bool operator==(const slot_handle &h1, const slot_handle &h2)
+{
+    return h1.index == h2.index && h1.generation == h2.generation;
+}
+inline bool operator!=(const slot_handle &h1, const slot_handle &h2)
+{
+    return !(h1 == h2);
+}
+
+// elements are stored densely in a vector, and handles reach them through an indirection table of slots. insertion,
+// erasure and lookup are all O(1). erasing moves the last element into the erased position, so iteration order is
+// insertion order until something is erased
+template <typename T> class slot_map
+{
+  public:
+    using handle = slot_handle;
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    template <class... Args> handle emplace(Args &&...args)
+    {
+        m_data.emplace_back(std::forward<Args>(args)...);
+
+        std::uint32_t index;
+        if (m_free_head != handle::NULL_INDEX)
+        {
+            index = m_free_head;
+            m_free_head = m_slots[index].index;
+        }
+        else
+        {
+            index = (std::uint32_t)m_slots.size();
+            m_slots.push_back({0, 0});
+        }
+
+        slot &s = m_slots[index];
+        s.index = (std::uint32_t)(m_data.size() - 1);
+        m_data_slots.push_back(index);
+        return {index, s.generation};
+    }
+    handle insert(const T &value)
+    {
+        return emplace(value);
+    }
+    handle insert(T &&value)
+    {
+        return emplace(std::move(value));
+    }
+
+    // returns false if the handle was already stale
+    bool erase(const handle h)
+    {
+        if (!contains(h))
+            return false;
+        slot &s = m_slots[h.index];
+        const std::uint32_t index = s.index;
+        const std::uint32_t last = (std::uint32_t)(m_data.size() - 1);
+        if (index != last)
+        {
+            m_data[index] = std::move(m_data[last]);
+            m_data_slots[index] = m_data_slots[last];
+            m_slots[m_data_slots[index]].index = index;
+        }
+        m_data.pop_back();
+        m_data_slots.pop_back();
+
+        ++s.generation;
+        s.index = m_free_head;
+        m_free_head = h.index;
+        return true;
+    }
+    iterator erase(const_iterator it)
+    {
+        const std::size_t index = std::distance(m_data.cbegin(), it);
+        erase(handle_of(index));
+        return m_data.begin() + index;
+    }
+
+    bool contains(const handle h) const
+    {
+        return h.index < m_slots.size() && m_slots[h.index].generation == h.generation &&
+               m_slots[h.index].index < m_data.size() && m_data_slots[m_slots[h.index].index] == h.index;
+    }
+
+    // returns nullptr if the handle is stale
+    const_pointer get(const handle h) const
+    {
+        return contains(h) ? &m_data[m_slots[h.index].index] : nullptr;
+    }
+    pointer get(const handle h)
+    {
+        return contains(h) ? &m_data[m_slots[h.index].index] : nullptr;
+    }
+
+    // position of the element in the dense storage. it changes when other elements are erased
+    std::size_t index_of(const handle h) const
+    {
+        KIT_ASSERT_ERROR(contains(h), "The handle is null or stale")
+        return m_slots[h.index].index;
+    }
+    handle handle_of(const std::size_t index) const
+    {
+        KIT_ASSERT_ERROR(index < m_data.size(), "Index exceeds container size: {0}", index)
+        const std::uint32_t s = m_data_slots[index];
+        return {s, m_slots[s].generation};
+    }
+
+    // every outstanding handle becomes stale
+    void clear()
+    {
+        for (const std::uint32_t s : m_data_slots)
+        {
+            ++m_slots[s].generation;
+            m_slots[s].index = m_free_head;
+            m_free_head = s;
+        }
+        m_data.clear();
+        m_data_slots.clear();
+    }
+    void reserve(const std::size_t capacity)
+    {
+        m_data.reserve(capacity);
+        m_data_slots.reserve(capacity);
+        m_slots.reserve(capacity);
+    }
+
+    std::size_t size() const
+    {
+        return m_data.size();
+    }
+    bool empty() const
+    {
+        return m_data.empty();
+    }
+
+    const_pointer data() const
+    {
+        return m_data.data();
+    }
+    pointer data()
+    {
+        return m_data.data();
+    }
+
+    iterator begin()
+    {
+        return m_data.begin();
+    }
+    iterator end()
+    {
+        return m_data.end();
+    }
+    const_iterator begin() const
+    {
+        return m_data.begin();
+    }
+    const_iterator end() const
+    {
+        return m_data.end();
+    }
+    const_iterator cbegin() const
+    {
+        return m_data.cbegin();
+    }
+    const_iterator cend() const
+    {
+        return m_data.cend();
+    }
+
+    reference operator[](const handle h)
+    {
+        KIT_ASSERT_ERROR(contains(h), "The handle is null or stale")
+        return m_data[m_slots[h.index].index];
+    }
+    const_reference operator[](const handle h) const
+    {
+        KIT_ASSERT_ERROR(contains(h), "The handle is null or stale")
+        return m_data[m_slots[h.index].index];
+    }
+
+  private:
+    // for live slots, index points to the dense storage. for free slots, it is the next free slot
+    struct slot
+    {
+        std::uint32_t index;
+        std::uint32_t generation;
+    };
+
+    std::vector<T> m_data;
+    std::vector<std::uint32_t> m_data_slots;
+    std::vector<slot> m_slots;
+    std::uint32_t m_free_head = handle::NULL_INDEX;
+};
+} // namespace kit
+
+template <> struct std::hash<kit::slot_handle>
+{
+    std::size_t operator()(const kit::slot_handle &h) const
+    {
+        return (std::size_t)kit::hash_mix(h);
+    }
+};
@@ -0,0 +1,468 @@
+#pragma once
+
+#include "kit/debug/log.hpp"
+#include "kit/memory/allocator/allocator.hpp"
+#include "kit/utility/type_constraints.hpp"
+#include <initializer_list>
+#include <array>
+#include <algorithm>
+#include <memory>
+#include <new>
+
+namespace kit
+{
+// vector that keeps up to N elements in inline storage and spills to the heap when it grows past that. spilled buffers
+// come from the given allocator if there is one (it must outlive the vector), or from the global aligned new otherwise.
+// a spilled buffer is first resized in place if the allocator supports it. otherwise, a new buffer is allocated before
+// the old one is released, so allocators that can only release their last allocation (such as stack_allocator) are only
+// usable as long as the buffer is on top of the stack and has room to grow there. note that, unlike dynarray, moving an
+// inlined small vector moves each element
+template <typename T, std::size_t N> class small_vector
+{
+  public:
+    static inline constexpr std::size_t INLINE_CAPACITY = N;
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using iterator = pointer;
+    using const_iterator = const_pointer;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    small_vector() = default;
+    // a template so that small_vector(0) picks the size constructor instead of being ambiguous
+    template <typename Alloc>
+        requires std::is_pointer_v<Alloc> && std::convertible_to<Alloc, continuous_allocator<T> *>
+    explicit small_vector(const Alloc allocator) : m_allocator(allocator)
+    {
+    }
+    small_vector(const size_type size, continuous_allocator<T> *allocator = nullptr) : m_allocator(allocator)
+    {
+        resize(size);
+    }
+    small_vector(const size_type size, const_reference value, continuous_allocator<T> *allocator = nullptr)
+        : m_allocator(allocator)
+    {
+        resize(size, value);
+    }
+
+    template <std::input_iterator It>
+    small_vector(It begin, It end, continuous_allocator<T> *allocator = nullptr) : m_allocator(allocator)
+    {
+        assign(begin, end);
+    }
+    small_vector(std::initializer_list<value_type> data, continuous_allocator<T> *allocator = nullptr)
+        : m_allocator(allocator)
+    {
+        assign(data.begin(), data.end());
+    }
+
+    // the copy uses the same allocator as the original
+    small_vector(const small_vector &other) : m_allocator(other.m_allocator)
+    {
+        assign(other.begin(), other.end());
+    }
+    small_vector(small_vector &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : m_allocator(other.m_allocator)
+    {
+        steal(other);
+    }
+
+    ~small_vector()
+    {
+        std::destroy(begin(), end());
+        if (!inlined())
+            deallocate(m_data, m_capacity);
+    }
+
+    small_vector &operator=(const small_vector &other)
+    {
+        if (this != &other)
+            assign(other.begin(), other.end());
+        return *this;
+    }
+    small_vector &operator=(small_vector &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+    {
+        if (this == &other)
+            return *this;
+        clear();
+        if (!inlined() && !other.inlined())
+        {
+            deallocate(m_data, m_capacity);
+            m_data = inline_data();
+            m_capacity = N;
+        }
+        if (!other.inlined())
+            m_allocator = other.m_allocator;
+        steal(other);
+        return *this;
+    }
+
+    template <std::input_iterator It> void assign(It begin, It end)
+    {
+        clear();
+        reserve(std::distance(begin, end));
+        m_size = std::uninitialized_copy(begin, end, m_data) - m_data;
+    }
+
+    template <class... Args> reference emplace_back(Args &&...args)
+    {
+        if (m_size < m_capacity)
+        {
+            pointer ptr = std::construct_at(m_data + m_size, std::forward<Args>(args)...);
+            ++m_size;
+            return *ptr;
+        }
+
+        // the new element is constructed before the old ones are moved, in case args refer to one of them
+        const size_type capacity = grown_capacity(m_size + 1);
+        if (resize_in_place(capacity))
+        {
+            pointer ptr = std::construct_at(m_data + m_size, std::forward<Args>(args)...);
+            ++m_size;
+            return *ptr;
+        }
+        pointer data = allocate(capacity);
+        std::construct_at(data + m_size, std::forward<Args>(args)...);
+        relocate(data, capacity);
+        return m_data[m_size++];
+    }
+    void push_back(const_reference elem)
+    {
+        emplace_back(elem);
+    }
+    void push_back(value_type &&elem)
+    {
+        emplace_back(std::move(elem));
+    }
+
+    template <class... Args> iterator emplace(const_iterator pos, Args &&...args)
+    {
+        KIT_ASSERT_ERROR(pos >= cbegin() && pos <= cend(), "Iterator must be within range");
+        const difference_type offset = std::distance(cbegin(), pos);
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + offset, end() - 1, end());
+        return begin() + offset;
+    }
+    iterator insert(const_iterator pos, const_reference elem)
+    {
+        return emplace(pos, elem);
+    }
+    iterator insert(const_iterator pos, value_type &&elem)
+    {
+        return emplace(pos, std::move(elem));
+    }
+    void push_front(const_reference elem)
+    {
+        insert(begin(), elem);
+    }
+    void push_front(value_type &&elem)
+    {
+        insert(begin(), std::move(elem));
+    }
+
+    void pop_back()
+    {
+        KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
+        std::destroy_at(m_data + --m_size);
+    }
+
+    // the capacity is kept
+    void clear()
+    {
+        std::destroy(begin(), end());
+        m_size = 0;
+    }
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    void reserve(const size_type capacity)
+    {
+        if (capacity > m_capacity && !resize_in_place(capacity))
+            relocate(allocate(capacity), capacity);
+    }
+    // moves the elements back to the inline storage if they fit
+    void shrink_to_fit()
+    {
+        if (inlined() || m_size == m_capacity)
+            return;
+        if (m_size <= N)
+            relocate(inline_data(), N);
+        else if (!resize_in_place(m_size))
+            relocate(allocate(m_size), m_size);
+    }
+
+    // new elements are default initialized, which leaves trivial types untouched
+    void resize(const size_type size)
+    {
+        reserve(size);
+        if (size > m_size)
+            std::uninitialized_default_construct(end(), begin() + size);
+        else
+            std::destroy(begin() + size, end());
+        m_size = size;
+    }
+    void resize(const size_type size, const_reference value)
+    {
+        if (size > m_capacity) // value may refer to one of the elements
+        {
+            const value_type copy = value;
+            reserve(size);
+            resize(size, copy);
+            return;
+        }
+        if (size > m_size)
+            std::uninitialized_fill(end(), begin() + size, value);
+        else
+            std::destroy(begin() + size, end());
+        m_size = size;
+    }
+
+    size_type size() const
+    {
+        return m_size;
+    }
+    size_type capacity() const
+    {
+        return m_capacity;
+    }
+    bool inlined() const
+    {
+        return m_data == inline_data();
+    }
+
+    continuous_allocator<T> *allocator() const
+    {
+        return m_allocator;
+    }
+
+    const_pointer data() const
+    {
+        return m_data;
+    }
+    pointer data()
+    {
+        return m_data;
+    }
+
+    reference front()
+    {
+        KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
+        return m_data[0];
+    }
+    reference back()
+    {
+        KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
+        return m_data[m_size - 1];
+    }
+
+    const_reference front() const
+    {
+        KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
+        return m_data[0];
+    }
+    const_reference back() const
+    {
+        KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero");
+        return m_data[m_size - 1];
+    }
+
+    iterator begin()
+    {
+        return m_data;
+    }
+    iterator end()
+    {
+        return m_data + m_size;
+    }
+    const_iterator begin() const
+    {
+        return m_data;
+    }
+    const_iterator end() const
+    {
+        return m_data + m_size;
+    }
+    const_iterator cbegin() const
+    {
+        return m_data;
+    }
+    const_iterator cend() const
+    {
+        return m_data + m_size;
+    }
+    reverse_iterator rbegin()
+    {
+        return reverse_iterator(end());
+    }
+    reverse_iterator rend()
+    {
+        return reverse_iterator(begin());
+    }
+    const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(end());
+    }
+    const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(begin());
+    }
+    const_reverse_iterator crbegin() const
+    {
+        return const_reverse_iterator(cend());
+    }
+    const_reverse_iterator crend() const
+    {
+        return const_reverse_iterator(cbegin());
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        KIT_ASSERT_ERROR(pos >= cbegin() && pos < cend(), "Iterator must be within range");
+        const difference_type offset = std::distance(cbegin(), pos);
+        std::move(begin() + offset + 1, end(), begin() + offset);
+        pop_back();
+
+        return begin() + offset;
+    }
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        KIT_ASSERT_ERROR(first >= cbegin() && first <= cend(), "Iterator must be within range");
+        KIT_ASSERT_ERROR(last >= cbegin() && last <= cend(), "Iterator must be within range");
+        KIT_ASSERT_ERROR(first <= last, "First iterator must be less than or equal to last iterator");
+        const difference_type offset = std::distance(cbegin(), first);
+        const difference_type count = std::distance(first, last);
+        std::move(begin() + offset + count, end(), begin() + offset);
+        std::destroy(end() - count, end());
+        m_size -= count;
+        return begin() + offset;
+    }
+
+    // moves the last element into the erased position. O(1), but does not preserve the order of the elements
+    iterator erase_unordered(const_iterator pos)
+    {
+        KIT_ASSERT_ERROR(pos >= cbegin() && pos < cend(), "Iterator must be within range");
+        const iterator it = begin() + std::distance(cbegin(), pos);
+        if (it != end() - 1)
+            *it = std::move(back());
+        pop_back();
+        return it;
+    }
+
+    // removes all elements satisfying the predicate in a single pass, keeping the order of the rest. returns the
+    // amount of removed elements
+    template <kit::RetCallable<bool, const_reference> F> size_type erase_if(F &&pred)
+    {
+        const iterator last = std::remove_if(begin(), end(), std::forward<F>(pred));
+        const size_type count = std::distance(last, end());
+        std::destroy(last, end());
+        m_size -= count;
+        return count;
+    }
+
+    reference operator[](const size_type index)
+    {
+        KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index);
+        return m_data[index];
+    }
+    const_reference operator[](const size_type index) const
+    {
+        KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index);
+        return m_data[index];
+    }
+
+    reference at(const size_type index)
+    {
+        KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index);
+        return m_data[index];
+    }
+    const_reference at(const size_type index) const
+    {
+        KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index);
+        return m_data[index];
+    }
+
+  private:
+    alignas(T) std::array<std::byte, sizeof(T) * N> m_inline;
+
+    T *m_data = inline_data();
+    size_type m_size = 0;
+    size_type m_capacity = N;
+
+    continuous_allocator<T> *m_allocator = nullptr;
+
+    pointer inline_data()
+    {
+        return reinterpret_cast<pointer>(m_inline.data());
+    }
+    const_pointer inline_data() const
+    {
+        return reinterpret_cast<const_pointer>(m_inline.data());
+    }
+
+    size_type grown_capacity(const size_type min_capacity) const
+    {
+        return std::max(2 * m_capacity, min_capacity);
+    }
+
+    pointer allocate(const size_type capacity)
+    {
+        if (m_allocator)
+            return m_allocator->nallocate(capacity);
+        return static_cast<pointer>(::operator new(capacity * sizeof(T), std::align_val_t{alignof(T)}));
+    }
+    void deallocate(pointer ptr, const size_type capacity)
+    {
+        if (m_allocator)
+            m_allocator->deallocate(ptr);
+        else
+            ::operator delete(ptr, capacity * sizeof(T), std::align_val_t{alignof(T)});
+    }
+
+    // keeps the elements where they are
+    bool resize_in_place(const size_type capacity)
+    {
+        if (inlined() || !m_allocator || !m_allocator->resize_in_place(m_data, capacity))
+            return false;
+        m_capacity = capacity;
+        return true;
+    }
+
+    // moves the elements to the given buffer and releases the current one
+    void relocate(pointer data, const size_type capacity)
+    {
+        std::uninitialized_move(begin(), end(), data);
+        std::destroy(begin(), end());
+        if (!inlined())
+            deallocate(m_data, m_capacity);
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    // expects this vector to be empty. heap buffers are taken over, while inlined elements have to be moved one by one
+    void steal(small_vector &other)
+    {
+        if (!other.inlined())
+        {
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_capacity = other.m_capacity;
+            other.m_data = other.inline_data();
+            other.m_size = 0;
+            other.m_capacity = N;
+            return;
+        }
+        reserve(other.m_size);
+        std::uninitialized_move(other.begin(), other.end(), m_data);
+        m_size = other.m_size;
+        other.clear();
+    }
+};
+} // namespace kit
@@ -0,0 +1,395 @@
+#pragma once
+
+#include "kit/debug/log.hpp"
+#include <tuple>
+#include <span>
+#include <memory>
+#include <new>
+#include <algorithm>
+#include <utility>
+#include <compare>
+#include <iterator>
+
+namespace kit
+{
+// structure of arrays vector: each field is stored in its own contiguous array, aligned to a cache line, so that loops
+// touching only a few fields do not drag the rest through the cache. elements are accessed as tuples of references,
+// which work with structured bindings, and each field can be taken as a span (and passed to mt::for_each, for example)
+template <typename... Fields> class soa_vector
+{
+  public:
+    static inline constexpr std::size_t ALIGNMENT = 64;
+    static inline constexpr std::size_t FIELDS = sizeof...(Fields);
+
+    template <std::size_t I> using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields &...>;
+    using const_reference = std::tuple<const Fields &...>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    template <bool Const> class iterator_base
+    {
+        using container = std::conditional_t<Const, const soa_vector, soa_vector>;
+
+      public:
+        // the references are proxies, so only the c++20 concept can be random access. the const iterator models it once
+        // tuples of references have common references with tuples of values, which is a c++23 library feature
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = soa_vector::value_type;
+        using reference = std::conditional_t<Const, soa_vector::const_reference, soa_vector::reference>;
+        using difference_type = soa_vector::difference_type;
+
+        iterator_base() = default;
+        iterator_base(container *soa, const size_type index) : m_soa(soa), m_index(index)
+        {
+        }
+
+        reference operator*() const
+        {
+            return (*m_soa)[m_index];
+        }
+        reference operator[](const difference_type offset) const
+        {
+            return (*m_soa)[m_index + offset];
+        }
+        size_type index() const
+        {
+            return m_index;
+        }
+
+        iterator_base &operator++()
+        {
+            ++m_index;
+            return *this;
+        }
+        iterator_base operator++(int)
+        {
+            iterator_base it = *this;
+            ++m_index;
+            return it;
+        }
+        iterator_base &operator--()
+        {
+            --m_index;
+            return *this;
+        }
+        iterator_base operator--(int)
+        {
+            iterator_base it = *this;
+            --m_index;
+            return it;
+        }
+        iterator_base &operator+=(const difference_type offset)
+        {
+            m_index += offset;
+            return *this;
+        }
+        iterator_base &operator-=(const difference_type offset)
+        {
+            m_index -= offset;
+            return *this;
+        }
+        iterator_base operator+(const difference_type offset) const
+        {
+            return {m_soa, m_index + offset};
+        }
+        iterator_base operator-(const difference_type offset) const
+        {
+            return {m_soa, m_index - offset};
+        }
+        friend iterator_base operator+(const difference_type offset, const iterator_base &it)
+        {
+            return it + offset;
+        }
+        difference_type operator-(const iterator_base &other) const
+        {
+            return (difference_type)m_index - (difference_type)other.m_index;
+        }
+
+        bool operator==(const iterator_base &other) const
+        {
+            return m_index == other.m_index;
+        }
+        auto operator<=>(const iterator_base &other) const
+        {
+            return m_index <=> other.m_index;
+        }
+
+      private:
+        container *m_soa = nullptr;
+        size_type m_index = 0;
+    };
+
+    using iterator = iterator_base<false>;
+    using const_iterator = iterator_base<true>;
+
+    soa_vector() = default;
+    soa_vector(const size_type size)
+    {
+        resize(size);
+    }
+
+    soa_vector(const soa_vector &other)
+    {
+        copy_from(other);
+    }
+    soa_vector(soa_vector &&other) noexcept
+        : m_data(other.m_data), m_size(other.m_size), m_capacity(other.m_capacity)
+    {
+        other.m_data = {};
+        other.m_size = 0;
+        other.m_capacity = 0;
+    }
+
+    ~soa_vector()
+    {
+        clear();
+        deallocate(m_data);
+    }
+
+    soa_vector &operator=(const soa_vector &other)
+    {
+        if (this != &other)
+        {
+            clear();
+            copy_from(other);
+        }
+        return *this;
+    }
+    soa_vector &operator=(soa_vector &&other) noexcept
+    {
+        if (this == &other)
+            return *this;
+        clear();
+        deallocate(m_data);
+        m_data = other.m_data;
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        other.m_data = {};
+        other.m_size = 0;
+        other.m_capacity = 0;
+        return *this;
+    }
+
+    // one argument per field
+    template <class... Args>
+        requires(sizeof...(Args) == FIELDS)
+    void emplace_back(Args &&...args)
+    {
+        if (m_size < m_capacity)
+        {
+            construct_fields(m_size, std::forward<Args>(args)...);
+            ++m_size;
+            return;
+        }
+        // the arguments may refer to elements of the vector, so they are captured before growing
+        value_type elem(std::forward<Args>(args)...);
+        reserve(std::max<size_type>(16, 2 * m_capacity));
+        std::apply([this](Fields &...fields) { construct_fields(m_size, std::move(fields)...); }, elem);
+        ++m_size;
+    }
+    void push_back(const value_type &elem)
+    {
+        std::apply([this](const Fields &...fields) { emplace_back(fields...); }, elem);
+    }
+    void push_back(value_type &&elem)
+    {
+        std::apply([this](Fields &...fields) { emplace_back(std::move(fields)...); }, elem);
+    }
+
+    void pop_back()
+    {
+        KIT_ASSERT_ERROR(m_size > 0, "Data size must be greater than zero")
+        --m_size;
+        for_each_field([this](auto *data) { std::destroy_at(data + m_size); });
+    }
+
+    // keeps the order of the elements
+    void erase(const size_type index)
+    {
+        KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index)
+        for_each_field([this, index](auto *data) { std::move(data + index + 1, data + m_size, data + index); });
+        pop_back();
+    }
+    // moves the last element into the erased position
+    void erase_unordered(const size_type index)
+    {
+        KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index)
+        if (index != m_size - 1)
+            for_each_field([this, index](auto *data) { data[index] = std::move(data[m_size - 1]); });
+        pop_back();
+    }
+
+    void clear()
+    {
+        for_each_field([this](auto *data) { std::destroy(data, data + m_size); });
+        m_size = 0;
+    }
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    void reserve(const size_type capacity)
+    {
+        if (capacity <= m_capacity)
+            return;
+        std::tuple<Fields *...> data = allocate(capacity);
+        for_each_field_pair(m_data, data, [this](auto *from, auto *to) {
+            std::uninitialized_move(from, from + m_size, to);
+            std::destroy(from, from + m_size);
+        });
+        deallocate(m_data);
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    // new elements are default initialized, which leaves trivial types untouched
+    void resize(const size_type size)
+    {
+        reserve(size);
+        if (size > m_size)
+            for_each_field(
+                [this, size](auto *data) { std::uninitialized_default_construct(data + m_size, data + size); });
+        else
+            for_each_field([this, size](auto *data) { std::destroy(data + size, data + m_size); });
+        m_size = size;
+    }
+
+    size_type size() const
+    {
+        return m_size;
+    }
+    size_type capacity() const
+    {
+        return m_capacity;
+    }
+
+    template <std::size_t I> std::span<field_type<I>> get()
+    {
+        return {std::get<I>(m_data), m_size};
+    }
+    template <std::size_t I> std::span<const field_type<I>> get() const
+    {
+        return {std::get<I>(m_data), m_size};
+    }
+
+    template <std::size_t I> field_type<I> *data()
+    {
+        return std::get<I>(m_data);
+    }
+    template <std::size_t I> const field_type<I> *data() const
+    {
+        return std::get<I>(m_data);
+    }
+
+    reference operator[](const size_type index)
+    {
+        KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index)
+        return std::apply([index](Fields *...data) { return reference{data[index]...}; }, m_data);
+    }
+    const_reference operator[](const size_type index) const
+    {
+        KIT_ASSERT_ERROR(index < m_size, "Index exceeds container size: {0}", index)
+        return std::apply([index](Fields *...data) { return const_reference{data[index]...}; }, m_data);
+    }
+
+    reference front()
+    {
+        return (*this)[0];
+    }
+    reference back()
+    {
+        return (*this)[m_size - 1];
+    }
+    const_reference front() const
+    {
+        return (*this)[0];
+    }
+    const_reference back() const
+    {
+        return (*this)[m_size - 1];
+    }
+
+    iterator begin()
+    {
+        return {this, 0};
+    }
+    iterator end()
+    {
+        return {this, m_size};
+    }
+    const_iterator begin() const
+    {
+        return {this, 0};
+    }
+    const_iterator end() const
+    {
+        return {this, m_size};
+    }
+    const_iterator cbegin() const
+    {
+        return {this, 0};
+    }
+    const_iterator cend() const
+    {
+        return {this, m_size};
+    }
+
+  private:
+    std::tuple<Fields *...> m_data{};
+    size_type m_size = 0;
+    size_type m_capacity = 0;
+
+    template <typename F> static constexpr std::align_val_t alignment()
+    {
+        return std::align_val_t{std::max(ALIGNMENT, alignof(F))};
+    }
+
+    template <typename F> void for_each_field(F &&fun)
+    {
+        std::apply([&fun](Fields *...data) { (fun(data), ...); }, m_data);
+    }
+    template <typename F>
+    static void for_each_field_pair(const std::tuple<Fields *...> &from, const std::tuple<Fields *...> &to, F &&fun)
+    {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (fun(std::get<I>(from), std::get<I>(to)), ...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    template <class... Args> void construct_fields(const size_type index, Args &&...args)
+    {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (std::construct_at(std::get<I>(m_data) + index, std::forward<Args>(args)), ...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    void copy_from(const soa_vector &other)
+    {
+        reserve(other.m_size);
+        for_each_field_pair(other.m_data, m_data, [&other](const auto *from, auto *to) {
+            std::uninitialized_copy(from, from + other.m_size, to);
+        });
+        m_size = other.m_size;
+    }
+
+    static std::tuple<Fields *...> allocate(const size_type capacity)
+    {
+        return {static_cast<Fields *>(::operator new(capacity * sizeof(Fields), alignment<Fields>()))...};
+    }
+    void deallocate(const std::tuple<Fields *...> &data)
+    {
+        if (m_capacity == 0)
+            return;
+        std::apply(
+            [this](Fields *...data) {
+                (::operator delete(data, m_capacity * sizeof(Fields), alignment<Fields>()), ...);
+            },
+            data);
+    }
+};
+} // namespace kit
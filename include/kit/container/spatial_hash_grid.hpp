@@ -0,0 +1,247 @@
+#pragma once
+
+#include "geo/algorithm/intersection.hpp"
+#include "kit/debug/log.hpp"
+#include "kit/multithreading/thread_pool.hpp"
+#include "kit/utility/type_constraints.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <bit>
+#include <algorithm>
+
+namespace kit
+{
+// uniform grid hashed into a fixed amount of buckets. it is meant for many objects of similar size (ideally, no bigger
+// than a cell) that are all reinserted every frame. as with the quad tree, this container does NOT own the elements
+
+// usage is insert everything, rebuild, then query. rebuild performs a counting sort of the entries into a single flat
+// array, so there are no per cell containers and no allocations once the buffers have grown to their working size.
+// an element is stored once per cell it overlaps, but queries and pair enumeration report it only once
+template <typename T> class spatial_hash_grid
+{
+  public:
+    struct entry
+    {
+        T element;
+        geo::aabb2D aabb;
+    };
+
+    // the bucket count is rounded up to the next power of two
+    spatial_hash_grid(const float cell_size = 1.f, const std::size_t bucket_count = 4096)
+        : m_cell_size(cell_size), m_inv_cell_size(1.f / cell_size), m_bucket_mask(std::bit_ceil(bucket_count) - 1),
+          m_bucket_start(m_bucket_mask + 2, 0)
+    {
+        KIT_ASSERT_ERROR(cell_size > 0.f, "Cell size must be greater than zero")
+    }
+
+    void insert(const T &element, const geo::aabb2D &aabb)
+    {
+        m_entries.push_back({element, aabb});
+        m_dirty = true;
+    }
+    void clear()
+    {
+        m_entries.clear();
+        m_dirty = true;
+    }
+
+    void rebuild()
+    {
+        const std::size_t bucket_count = m_bucket_mask + 1;
+        std::fill(m_bucket_start.begin(), m_bucket_start.end(), 0);
+
+        m_min_cells.resize(m_entries.size());
+        for (std::size_t i = 0; i < m_entries.size(); i++)
+        {
+            m_min_cells[i] = to_cell(m_entries[i].aabb.min);
+            for_each_bucket(m_entries[i].aabb, [this](const std::uint32_t bucket) { ++m_bucket_start[bucket + 1]; });
+        }
+        for (std::size_t i = 0; i < bucket_count; i++)
+            m_bucket_start[i + 1] += m_bucket_start[i];
+
+        m_bucket_entries.resize(m_bucket_start.back());
+        m_cursor.assign(m_bucket_start.begin(), m_bucket_start.end() - 1);
+        for (std::size_t i = 0; i < m_entries.size(); i++)
+            for_each_bucket(m_entries[i].aabb, [this, i](const std::uint32_t bucket) {
+                m_bucket_entries[m_cursor[bucket]++] = (std::uint32_t)i;
+            });
+        m_dirty = false;
+    }
+
+    template <kit::RetCallable<bool, const T> F> void traverse(F &&fun) const
+    {
+        for (const entry &e : m_entries)
+            if (!std::forward<F>(fun)(e.element))
+                return;
+    }
+    template <kit::RetCallable<bool, T> F> void traverse(F &&fun)
+    {
+        for (entry &e : m_entries)
+            if (!std::forward<F>(fun)(e.element))
+                return;
+    }
+
+    // only elements whose aabb intersects the given one are passed to the callback
+    template <kit::RetCallable<bool, const T> F> void traverse(F &&fun, const geo::aabb2D &aabb) const
+    {
+        traverse_entries(*this, std::forward<F>(fun), aabb);
+    }
+    template <kit::RetCallable<bool, T> F> void traverse(F &&fun, const geo::aabb2D &aabb)
+    {
+        traverse_entries(*this, std::forward<F>(fun), aabb);
+    }
+
+    // calls the function exactly once for every pair of elements whose aabbs intersect
+    template <kit::VoidCallable<const T &, const T &> F> void for_each_pair(F &&fun) const
+    {
+        for_each_pair_in_buckets(0, m_bucket_mask + 1, fun);
+    }
+
+    // same as above, but the bucket range is split into workloads that run on the pool. the function will be called
+    // concurrently, and must be thread safe
+    template <kit::VoidCallable<const T &, const T &> F>
+    void for_each_pair(mt::thread_pool &pool, F &&fun, const std::size_t workloads) const
+    {
+        KIT_ASSERT_ERROR(workloads != 0, "Workload count must be greater than 0")
+        const std::size_t bucket_count = m_bucket_mask + 1;
+        std::size_t start = 0;
+        for (std::size_t i = 0; i < workloads; i++)
+        {
+            const std::size_t end = (i + 1) * bucket_count / workloads;
+            if (end > start)
+                pool.submit([this, &fun](const std::size_t start,
+                                         const std::size_t end) { for_each_pair_in_buckets(start, end, fun); },
+                            start, end);
+            start = end;
+        }
+        pool.await_pending();
+    }
+
+    const std::vector<entry> &entries() const
+    {
+        return m_entries;
+    }
+    std::size_t size() const
+    {
+        return m_entries.size();
+    }
+    bool empty() const
+    {
+        return m_entries.empty();
+    }
+
+    float cell_size() const
+    {
+        return m_cell_size;
+    }
+    std::size_t bucket_count() const
+    {
+        return m_bucket_mask + 1;
+    }
+
+  private:
+    struct cell
+    {
+        std::int32_t x;
+        std::int32_t y;
+    };
+
+    std::vector<entry> m_entries;
+    float m_cell_size;
+    float m_inv_cell_size;
+    std::size_t m_bucket_mask;
+
+    // bucket i spans m_bucket_entries[m_bucket_start[i], m_bucket_start[i + 1])
+    std::vector<std::uint32_t> m_bucket_start;
+    std::vector<std::uint32_t> m_bucket_entries;
+    std::vector<cell> m_min_cells;
+
+    std::vector<std::uint32_t> m_cursor;
+    std::vector<std::uint32_t> m_scratch;
+    bool m_dirty = false;
+
+    // each matching element is reported only from its reference cell: the lowest cell of its overlap with the query
+    template <typename Self, typename F>
+    static void traverse_entries(Self &self, F &&fun, const geo::aabb2D &aabb)
+    {
+        KIT_ASSERT_ERROR(!self.m_dirty, "The grid must be rebuilt after inserting or clearing elements")
+        const cell mm = self.to_cell(aabb.min);
+        const cell mx = self.to_cell(aabb.max);
+        for (std::int32_t x = mm.x; x <= mx.x; x++)
+            for (std::int32_t y = mm.y; y <= mx.y; y++)
+            {
+                const std::uint32_t bucket = self.hash(x, y);
+                for (std::uint32_t i = self.m_bucket_start[bucket]; i < self.m_bucket_start[bucket + 1]; i++)
+                {
+                    const std::uint32_t index = self.m_bucket_entries[i];
+                    auto &e = self.m_entries[index];
+                    const cell &emm = self.m_min_cells[index];
+                    if (std::max(emm.x, mm.x) == x && std::max(emm.y, mm.y) == y && geo::intersects(e.aabb, aabb) &&
+                        !std::forward<F>(fun)(e.element))
+                        return;
+                }
+            }
+    }
+
+    // an element appears at most once per bucket, and a pair is reported only from the bucket of its reference cell
+    template <typename F>
+    void for_each_pair_in_buckets(const std::size_t start, const std::size_t end, F &&fun) const
+    {
+        KIT_ASSERT_ERROR(!m_dirty, "The grid must be rebuilt after inserting or clearing elements")
+        for (std::size_t bucket = start; bucket < end; bucket++)
+        {
+            const std::uint32_t first = m_bucket_start[bucket];
+            const std::uint32_t last = m_bucket_start[bucket + 1];
+            for (std::uint32_t i = first; i < last; i++)
+            {
+                const std::uint32_t index1 = m_bucket_entries[i];
+                const entry &e1 = m_entries[index1];
+                const cell &c1 = m_min_cells[index1];
+                for (std::uint32_t j = i + 1; j < last; j++)
+                {
+                    const std::uint32_t index2 = m_bucket_entries[j];
+                    const entry &e2 = m_entries[index2];
+                    const cell &c2 = m_min_cells[index2];
+                    if (hash(std::max(c1.x, c2.x), std::max(c1.y, c2.y)) == bucket &&
+                        geo::intersects(e1.aabb, e2.aabb))
+                        fun(e1.element, e2.element);
+                }
+            }
+        }
+    }
+
+    // distinct cells of the same aabb may collide into the same bucket. those are only visited once
+    template <typename F> void for_each_bucket(const geo::aabb2D &aabb, F &&fun)
+    {
+        const cell mm = to_cell(aabb.min);
+        const cell mx = to_cell(aabb.max);
+        if (mm.x == mx.x && mm.y == mx.y)
+        {
+            fun(hash(mm.x, mm.y));
+            return;
+        }
+
+        m_scratch.clear();
+        for (std::int32_t x = mm.x; x <= mx.x; x++)
+            for (std::int32_t y = mm.y; y <= mx.y; y++)
+                m_scratch.push_back(hash(x, y));
+        std::sort(m_scratch.begin(), m_scratch.end());
+        const auto last = std::unique(m_scratch.begin(), m_scratch.end());
+        for (auto it = m_scratch.begin(); it != last; ++it)
+            fun(*it);
+    }
+
+    cell to_cell(const glm::vec2 &point) const
+    {
+        return {(std::int32_t)std::floor(point.x * m_inv_cell_size), (std::int32_t)std::floor(point.y * m_inv_cell_size)};
+    }
+    std::uint32_t hash(const std::int32_t x, const std::int32_t y) const
+    {
+        std::uint32_t h = (std::uint32_t)x * 0x9E3779B1u ^ (std::uint32_t)y * 0x85EBCA77u;
+        h ^= h >> 16;
+        return h & (std::uint32_t)m_bucket_mask;
+    }
+};
+} // namespace kit
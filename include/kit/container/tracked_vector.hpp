@@ -0,0 +1,269 @@
+#pragma once
+
+#include "kit/interface/identifiable.hpp"
+#include "kit/debug/log.hpp"
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <bit>
+
+namespace kit
+{
+// vector of identifiable elements that keeps an id to index table up to date on every mutation, so that find_index is
+// O(1). the table uses open addressing with linear probing and is kept at most half full. elements must not change
+// their id while stored (for example, by assigning a different element through operator[])
+template <Identifiable T> class tracked_vector
+{
+  public:
+    using id_type = typename T::id_type;
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using reference = value_type &;
+    using const_reference = const value_type &;
+    using pointer = value_type *;
+    using const_pointer = const value_type *;
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    template <class... Args> reference emplace_back(Args &&...args)
+    {
+        reference elem = m_data.emplace_back(std::forward<Args>(args)...);
+        table_insert(elem.id(), m_data.size() - 1);
+        return elem;
+    }
+    void push_back(const T &elem)
+    {
+        emplace_back(elem);
+    }
+    void push_back(T &&elem)
+    {
+        emplace_back(std::move(elem));
+    }
+
+    void pop_back()
+    {
+        KIT_ASSERT_ERROR(!m_data.empty(), "Data size must be greater than zero")
+        table_erase(m_data.back().id());
+        m_data.pop_back();
+    }
+
+    // keeps the order of the elements, so every element after the erased one has its index updated
+    iterator erase(const_iterator pos)
+    {
+        const std::size_t index = std::distance(m_data.cbegin(), pos);
+        table_erase(pos->id());
+        const iterator it = m_data.erase(pos);
+        for (std::size_t i = index; i < m_data.size(); i++)
+            table_find(m_data[i].id())->index = (std::uint32_t)i;
+        return it;
+    }
+    // moves the last element into the erased position. only one index has to be updated
+    iterator erase_unordered(const_iterator pos)
+    {
+        const std::size_t index = std::distance(m_data.cbegin(), pos);
+        swap(index, m_data.size() - 1);
+        pop_back();
+        return m_data.begin() + index;
+    }
+    bool erase(const id_type &id)
+    {
+        const std::size_t index = find_index(id);
+        if (index == SIZE_MAX)
+            return false;
+        erase(m_data.begin() + index);
+        return true;
+    }
+
+    void swap(const std::size_t index1, const std::size_t index2)
+    {
+        KIT_ASSERT_ERROR(index1 < m_data.size() && index2 < m_data.size(), "Indices exceed container size")
+        if (index1 == index2)
+            return;
+        std::swap(m_data[index1], m_data[index2]);
+        table_find(m_data[index1].id())->index = (std::uint32_t)index1;
+        table_find(m_data[index2].id())->index = (std::uint32_t)index2;
+    }
+
+    // returns SIZE_MAX if the id is not present
+    std::size_t find_index(const id_type &id) const
+    {
+        const slot *s = table_find(id);
+        return s ? s->index : SIZE_MAX;
+    }
+    bool contains(const id_type &id) const
+    {
+        return table_find(id) != nullptr;
+    }
+
+    void clear()
+    {
+        m_data.clear();
+        std::fill(m_table.begin(), m_table.end(), slot{});
+    }
+    void reserve(const std::size_t capacity)
+    {
+        m_data.reserve(capacity);
+        if (2 * capacity > m_table.size())
+            rehash(std::bit_ceil(2 * capacity));
+    }
+
+    std::size_t size() const
+    {
+        return m_data.size();
+    }
+    bool empty() const
+    {
+        return m_data.empty();
+    }
+
+    const_pointer data() const
+    {
+        return m_data.data();
+    }
+    pointer data()
+    {
+        return m_data.data();
+    }
+
+    reference front()
+    {
+        return m_data.front();
+    }
+    reference back()
+    {
+        return m_data.back();
+    }
+    const_reference front() const
+    {
+        return m_data.front();
+    }
+    const_reference back() const
+    {
+        return m_data.back();
+    }
+
+    iterator begin()
+    {
+        return m_data.begin();
+    }
+    iterator end()
+    {
+        return m_data.end();
+    }
+    const_iterator begin() const
+    {
+        return m_data.begin();
+    }
+    const_iterator end() const
+    {
+        return m_data.end();
+    }
+    const_iterator cbegin() const
+    {
+        return m_data.cbegin();
+    }
+    const_iterator cend() const
+    {
+        return m_data.cend();
+    }
+
+    reference operator[](const std::size_t index)
+    {
+        return m_data[index];
+    }
+    const_reference operator[](const std::size_t index) const
+    {
+        return m_data[index];
+    }
+
+  private:
+    struct slot
+    {
+        static inline constexpr std::uint32_t EMPTY = UINT32_MAX;
+
+        id_type id{};
+        std::uint32_t index = EMPTY;
+
+        bool empty() const
+        {
+            return index == EMPTY;
+        }
+    };
+
+    std::vector<T> m_data;
+    std::vector<slot> m_table;
+
+    std::size_t home(const id_type &id) const
+    {
+        return std::hash<id_type>()(id) & (m_table.size() - 1);
+    }
+
+    const slot *table_find(const id_type &id) const
+    {
+        if (m_table.empty())
+            return nullptr;
+        for (std::size_t i = home(id);; i = (i + 1) & (m_table.size() - 1))
+        {
+            const slot &s = m_table[i];
+            if (s.empty())
+                return nullptr;
+            if (s.id == id)
+                return &s;
+        }
+    }
+    slot *table_find(const id_type &id)
+    {
+        return const_cast<slot *>(std::as_const(*this).table_find(id));
+    }
+
+    // the element must already be in the data vector, so that a rehash picks it up
+    void table_insert(const id_type &id, const std::size_t index)
+    {
+        if (2 * m_data.size() > m_table.size())
+        {
+            rehash(std::max<std::size_t>(16, 2 * m_table.size()));
+            return;
+        }
+        place(id, index);
+    }
+    void place(const id_type &id, const std::size_t index)
+    {
+        std::size_t i = home(id);
+        while (!m_table[i].empty())
+        {
+            KIT_ASSERT_ERROR(m_table[i].id != id, "An element with the same id is already in the container")
+            i = (i + 1) & (m_table.size() - 1);
+        }
+        m_table[i] = {id, (std::uint32_t)index};
+    }
+
+    // backward shift deletion: following entries of the same probe run are moved back, so no tombstones are needed
+    void table_erase(const id_type &id)
+    {
+        slot *s = table_find(id);
+        KIT_ASSERT_ERROR(s, "The id is not present in the container")
+        const std::size_t mask = m_table.size() - 1;
+        std::size_t hole = s - m_table.data();
+        for (std::size_t i = (hole + 1) & mask; !m_table[i].empty(); i = (i + 1) & mask)
+        {
+            // the entry can fill the hole only if its home does not lie cyclically in (hole, i]
+            const std::size_t h = home(m_table[i].id);
+            if (((i - h) & mask) >= ((i - hole) & mask))
+            {
+                m_table[hole] = m_table[i];
+                hole = i;
+            }
+        }
+        m_table[hole] = slot{};
+    }
+
+    void rehash(const std::size_t capacity)
+    {
+        m_table.assign(capacity, slot{});
+        for (std::size_t i = 0; i < m_data.size(); i++)
+            place(m_data[i].id(), i);
+    }
+};
+} // namespace kit
@@ -0,0 +1,186 @@
+#pragma once
+
+#ifdef KIT_USE_SPDLOG
+#include "kit/interface/non_copyable.hpp"
+#include <spdlog/spdlog.h>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <type_traits>
+
+namespace kit
+{
+enum class log_overflow_policy
+{
+    DROP, // the message is discarded and counted
+    BLOCK // the producer waits until the background thread makes room
+};
+
+struct async_log_settings
+{
+    std::size_t ring_capacity = 1024; // per thread, rounded up to a power of two
+    log_overflow_policy overflow_policy = log_overflow_policy::DROP;
+};
+
+// a message waiting to be formatted: the format string (which must outlive the logger, as literals do), the raw
+// arguments and a function that knows their types. the function formats the message and destroys the arguments
+struct _log_record
+{
+    static inline constexpr std::size_t PAYLOAD_SIZE = 96;
+
+    using consumer = void (*)(_log_record &, fmt::memory_buffer &);
+
+    consumer consume;
+    spdlog::level::level_enum level;
+    std::string_view format;
+    alignas(std::max_align_t) std::byte payload[PAYLOAD_SIZE];
+};
+
+// single producer, single consumer ring. the producer is the thread that owns it, and the consumer is the background
+// thread of the logger
+class _log_ring
+{
+  public:
+    _log_ring(std::size_t capacity);
+
+    _log_record *try_claim();
+    void commit();
+
+    _log_record *front();
+    void pop();
+
+    bool empty() const;
+    // the amount of records committed and written so far
+    std::size_t committed() const;
+    std::size_t written() const;
+
+    std::atomic<bool> closed{false};
+
+  private:
+    std::vector<_log_record> m_records;
+    std::size_t m_mask;
+
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
+
+// formats and writes messages on a background thread. each thread logs into its own lock free ring, storing only the
+// format string and a copy of the arguments (c strings and string views are copied into strings, as they may not
+// outlive the call). arguments too big for a record are formatted on the calling thread instead. messages from a
+// single thread keep their order, but messages from different threads may be interleaved differently than they were
+// logged. the output is the default spdlog logger at the time the async logger is first used, which is kept alive
+// until the async logger shuts down, with its runtime level checked before enqueuing. the background thread sleeps
+// while there is nothing to write
+class async_logger : non_copyable
+{
+  public:
+    ~async_logger();
+
+    static async_logger &main();
+
+    // only rings created afterwards (by threads logging for the first time) use the new capacity
+    void configure(const async_log_settings &settings);
+
+    template <class... Args>
+    void log(const spdlog::level::level_enum level, spdlog::format_string_t<Args...> format, Args &&...args)
+    {
+        if (!m_logger->should_log(level))
+            return;
+        if (!m_running.load(std::memory_order_acquire))
+        {
+            m_logger->log(level, format, std::forward<Args>(args)...);
+            return;
+        }
+
+        using payload = std::tuple<stored_arg<Args>...>;
+        if constexpr (sizeof(payload) <= _log_record::PAYLOAD_SIZE && alignof(payload) <= alignof(std::max_align_t))
+            enqueue<payload>(level, fmt::string_view(format), std::forward<Args>(args)...);
+        else
+            enqueue<std::tuple<std::string>>(level, "{}", fmt::format(format, std::forward<Args>(args)...));
+    }
+
+    // blocks until every message logged before the call has been written. messages logged while it waits are not
+    // waited for, so other threads that keep logging cannot stall it
+    void flush();
+
+    // writes every pending message and stops the background thread. later messages are written synchronously. called
+    // on destruction, but it may be called earlier to control when the output is finalized. threads still logging
+    // while it runs may lose messages
+    void shutdown();
+
+    std::size_t dropped() const;
+
+  private:
+    async_logger();
+
+    template <typename T>
+    static inline constexpr bool IS_STRING_REFERENCE =
+        std::is_same_v<std::decay_t<T>, const char *> || std::is_same_v<std::decay_t<T>, char *> ||
+        std::is_same_v<std::decay_t<T>, std::string_view>;
+
+    template <typename T> using stored_arg = std::conditional_t<IS_STRING_REFERENCE<T>, std::string, std::decay_t<T>>;
+
+    // shared so that a flush can keep waiting on a ring the background thread has already released
+    std::vector<std::shared_ptr<_log_ring>> m_rings;
+    std::vector<std::shared_ptr<_log_ring>> m_draining; // only touched by the background thread
+    std::mutex m_rings_mutex;
+
+    std::atomic<std::size_t> m_ring_capacity{1024};
+    std::atomic<log_overflow_policy> m_overflow_policy{log_overflow_policy::DROP};
+    std::atomic<std::size_t> m_dropped{0};
+
+    std::shared_ptr<spdlog::logger> m_logger;
+
+    std::mutex m_wake_mutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_signaled{false};
+    std::atomic<bool> m_running{true};
+
+    // declared last, so that everything the background thread touches is already initialized when it starts
+    std::thread m_thread;
+
+    template <typename Payload, class... Args>
+    void enqueue(const spdlog::level::level_enum level, const fmt::string_view format, Args &&...args)
+    {
+        _log_record *record = claim();
+        if (!record)
+        {
+            // the background thread stopped while this thread was waiting for room
+            if (!m_running.load(std::memory_order_acquire))
+                m_logger->log(level, fmt::runtime(format), std::forward<Args>(args)...);
+            return;
+        }
+        record->level = level;
+        record->format = std::string_view(format.data(), format.size());
+        new (record->payload) Payload(std::forward<Args>(args)...);
+        record->consume = [](_log_record &rec, fmt::memory_buffer &buffer) {
+            Payload *args = std::launder(reinterpret_cast<Payload *>(rec.payload));
+            // the arguments are destroyed even if a formatter throws
+            const auto destroy = [](Payload *p) { std::destroy_at(p); };
+            const std::unique_ptr<Payload, decltype(destroy)> guard{args, destroy};
+            std::apply(
+                [&rec, &buffer](auto &...pargs) {
+                    fmt::vformat_to(fmt::appender(buffer), fmt::string_view(rec.format.data(), rec.format.size()),
+                                    fmt::make_format_args(pargs...));
+                },
+                *args);
+        };
+        thread_ring().commit();
+        wake();
+    }
+
+    _log_ring &thread_ring();
+    _log_record *claim();
+
+    void wake();
+    void run();
+    bool drain(fmt::memory_buffer &buffer);
+};
+} // namespace kit
+#endif
@@ -1,8 +1,32 @@
 #pragma once
 
+// log levels, to be used with KIT_LOG_LEVEL. calls below the chosen level are removed at compile time, so they cost
+// nothing even where spdlog's runtime level would discard them
+#define KIT_LOG_LEVEL_TRACE 0
+#define KIT_LOG_LEVEL_DEBUG 1
+#define KIT_LOG_LEVEL_INFO 2
+#define KIT_LOG_LEVEL_WARN 3
+#define KIT_LOG_LEVEL_ERROR 4
+#define KIT_LOG_LEVEL_CRITICAL 5
+#define KIT_LOG_LEVEL_OFF 6
+
+#ifndef KIT_LOG_LEVEL
+#define KIT_LOG_LEVEL KIT_LOG_LEVEL_TRACE
+#endif
+
+#if defined(KIT_LOG) && defined(KIT_USE_SPDLOG)
+#define KIT_ACTIVE_LOG_LEVEL KIT_LOG_LEVEL
+#else
+#define KIT_ACTIVE_LOG_LEVEL KIT_LOG_LEVEL_OFF
+#endif
+
 #if defined(KIT_LOG) && defined(KIT_USE_SPDLOG)
 #include <signal.h>
 #include <spdlog/spdlog.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
 
 #ifdef __clang__
 #define KIT_BREAK() __builtin_debugtrap();
@@ -18,73 +42,152 @@
 #define KIT_SET_LEVEL(lvl) spdlog::set_level(spdlog::level::lvl);
 #define KIT_SET_PATTERN(patt) spdlog::set_pattern(patt);
 
-#define KIT_TRACE(...) spdlog::trace(__VA_ARGS__);
-#define KIT_DEBUG(...) spdlog::debug(__VA_ARGS__);
-#define KIT_INFO(...) spdlog::info(__VA_ARGS__);
-#ifndef KIT_WARNINGS_AS_ERRORS
-#define KIT_WARN(...) spdlog::warn(__VA_ARGS__);
+// with KIT_ASYNC_LOG, messages are formatted and written on a background thread (see async_log.hpp). errors and
+// critical messages are always written right away, as they are followed by a break. pending messages are flushed
+// first, so that they are not lost and the order is kept
+#ifdef KIT_ASYNC_LOG
+#include "kit/debug/async_log.hpp"
+#define _KIT_LOG(lvl, ...) kit::async_logger::main().log(spdlog::level::lvl, __VA_ARGS__);
+#define _KIT_FLUSH_ASYNC() kit::async_logger::main().flush();
 #else
-#define KIT_WARN(...)                                                                                                  \
-    spdlog::error(__VA_ARGS__);                                                                                        \
-    KIT_BREAK()
+#define _KIT_LOG(lvl, ...) spdlog::lvl(__VA_ARGS__);
+#define _KIT_FLUSH_ASYNC()
 #endif
-#define KIT_ERROR(...)                                                                                                 \
-    spdlog::error(__VA_ARGS__);                                                                                        \
-    KIT_BREAK()
-#define KIT_CRITICAL(...)                                                                                              \
-    spdlog::critical(__VA_ARGS__);                                                                                     \
+#define _KIT_LOG_AND_BREAK(lvl, ...)                                                                                   \
+    _KIT_FLUSH_ASYNC()                                                                                                 \
+    spdlog::lvl(__VA_ARGS__);                                                                                          \
     KIT_BREAK()
 
-#define KIT_ASSERT_TRACE(cond, ...)                                                                                    \
-    if (!(cond))                                                                                                       \
-    {                                                                                                                  \
-        KIT_TRACE(__VA_ARGS__)                                                                                         \
-    }
-#define KIT_ASSERT_DEBUG(cond, ...)                                                                                    \
-    if (!(cond))                                                                                                       \
-    {                                                                                                                  \
-        KIT_DEBUG(__VA_ARGS__)                                                                                         \
-    }
-#define KIT_ASSERT_INFO(cond, ...)                                                                                     \
-    if (!(cond))                                                                                                       \
-    {                                                                                                                  \
-        KIT_INFO(__VA_ARGS__)                                                                                          \
-    }
-#define KIT_ASSERT_WARN(cond, ...)                                                                                     \
-    if (!(cond))                                                                                                       \
+namespace kit
+{
+// true once every interval_ms milliseconds. if several threads reach the same call site at once, only one of them wins
+inline bool _log_interval_elapsed(std::atomic<std::int64_t> &last, const std::int64_t interval_ms)
+{
+    const std::int64_t now =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    std::int64_t previous = last.load(std::memory_order_relaxed);
+    if (previous != std::numeric_limits<std::int64_t>::min() && now - previous < interval_ms)
+        return false;
+    return last.compare_exchange_strong(previous, now, std::memory_order_relaxed);
+}
+} // namespace kit
+
+// rate limited variants. each call site keeps its own counter or timestamp, so a message logged from a hot loop is only
+// formatted every n calls (every call if n is 0 or 1) or every ms milliseconds
+#define _KIT_EVERY_N(level, n, ...)                                                                                    \
     {                                                                                                                  \
-        KIT_WARN(__VA_ARGS__)                                                                                          \
+        static std::atomic<std::uint64_t> _kit_log_count{0};                                                           \
+        if ((n) <= 1 || _kit_log_count.fetch_add(1, std::memory_order_relaxed) % (n) == 0)                             \
+        {                                                                                                              \
+            KIT_##level(__VA_ARGS__)                                                                                   \
+        }                                                                                                              \
     }
-#define KIT_ASSERT_ERROR(cond, ...)                                                                                    \
-    if (!(cond))                                                                                                       \
+#define _KIT_EVERY_MS(level, ms, ...)                                                                                  \
     {                                                                                                                  \
-        KIT_ERROR(__VA_ARGS__)                                                                                         \
+        static std::atomic<std::int64_t> _kit_log_last{std::numeric_limits<std::int64_t>::min()};                      \
+        if (kit::_log_interval_elapsed(_kit_log_last, static_cast<std::int64_t>(ms)))                                  \
+        {                                                                                                              \
+            KIT_##level(__VA_ARGS__)                                                                                   \
+        }                                                                                                              \
     }
-#define KIT_ASSERT_CRITICAL(cond, ...)                                                                                 \
+#define _KIT_ASSERT(level, cond, ...)                                                                                  \
     if (!(cond))                                                                                                       \
     {                                                                                                                  \
-        KIT_CRITICAL(__VA_ARGS__)                                                                                      \
+        KIT_##level(__VA_ARGS__)                                                                                       \
     }
+#endif
 
-#define KIT_CHECK_RETURN_VALUE(expression, expected, level, ...) KIT_ASSERT_##level(expression == expected, __VA_ARGS__)
+#if KIT_ACTIVE_LOG_LEVEL <= KIT_LOG_LEVEL_TRACE
+#define KIT_TRACE(...) _KIT_LOG(trace, __VA_ARGS__)
+#define KIT_ASSERT_TRACE(cond, ...) _KIT_ASSERT(TRACE, cond, __VA_ARGS__)
+#define KIT_TRACE_EVERY_N(n, ...) _KIT_EVERY_N(TRACE, n, __VA_ARGS__)
+#define KIT_TRACE_EVERY_MS(ms, ...) _KIT_EVERY_MS(TRACE, ms, __VA_ARGS__)
 #else
-#define KIT_SET_LEVEL(lvl)
-#define KIT_SET_PATTERN(patt)
-
 #define KIT_TRACE(...)
-#define KIT_DEBUG(...)
-#define KIT_INFO(...)
-#define KIT_WARN(...)
-#define KIT_ERROR(...)
-#define KIT_CRITICAL(...)
-#define KIT_FATAL(...)
-
 #define KIT_ASSERT_TRACE(cond, ...)
+#define KIT_TRACE_EVERY_N(n, ...)
+#define KIT_TRACE_EVERY_MS(ms, ...)
+#endif
+
+#if KIT_ACTIVE_LOG_LEVEL <= KIT_LOG_LEVEL_DEBUG
+#define KIT_DEBUG(...) _KIT_LOG(debug, __VA_ARGS__)
+#define KIT_ASSERT_DEBUG(cond, ...) _KIT_ASSERT(DEBUG, cond, __VA_ARGS__)
+#define KIT_DEBUG_EVERY_N(n, ...) _KIT_EVERY_N(DEBUG, n, __VA_ARGS__)
+#define KIT_DEBUG_EVERY_MS(ms, ...) _KIT_EVERY_MS(DEBUG, ms, __VA_ARGS__)
+#else
+#define KIT_DEBUG(...)
 #define KIT_ASSERT_DEBUG(cond, ...)
+#define KIT_DEBUG_EVERY_N(n, ...)
+#define KIT_DEBUG_EVERY_MS(ms, ...)
+#endif
+
+#if KIT_ACTIVE_LOG_LEVEL <= KIT_LOG_LEVEL_INFO
+#define KIT_INFO(...) _KIT_LOG(info, __VA_ARGS__)
+#define KIT_ASSERT_INFO(cond, ...) _KIT_ASSERT(INFO, cond, __VA_ARGS__)
+#define KIT_INFO_EVERY_N(n, ...) _KIT_EVERY_N(INFO, n, __VA_ARGS__)
+#define KIT_INFO_EVERY_MS(ms, ...) _KIT_EVERY_MS(INFO, ms, __VA_ARGS__)
+#else
+#define KIT_INFO(...)
 #define KIT_ASSERT_INFO(cond, ...)
+#define KIT_INFO_EVERY_N(n, ...)
+#define KIT_INFO_EVERY_MS(ms, ...)
+#endif
+
+// warnings treated as errors are filtered as errors
+#if KIT_ACTIVE_LOG_LEVEL <= KIT_LOG_LEVEL_WARN ||                                                                      \
+    (defined(KIT_WARNINGS_AS_ERRORS) && KIT_ACTIVE_LOG_LEVEL <= KIT_LOG_LEVEL_ERROR)
+#ifndef KIT_WARNINGS_AS_ERRORS
+#define KIT_WARN(...) _KIT_LOG(warn, __VA_ARGS__)
+#else
+#define KIT_WARN(...) _KIT_LOG_AND_BREAK(error, __VA_ARGS__)
+#endif
+#define KIT_ASSERT_WARN(cond, ...) _KIT_ASSERT(WARN, cond, __VA_ARGS__)
+#define KIT_WARN_EVERY_N(n, ...) _KIT_EVERY_N(WARN, n, __VA_ARGS__)
+#define KIT_WARN_EVERY_MS(ms, ...) _KIT_EVERY_MS(WARN, ms, __VA_ARGS__)
+#else
+#define KIT_WARN(...)
 #define KIT_ASSERT_WARN(cond, ...)
+#define KIT_WARN_EVERY_N(n, ...)
+#define KIT_WARN_EVERY_MS(ms, ...)
+#endif
+
+#if KIT_ACTIVE_LOG_LEVEL <= KIT_LOG_LEVEL_ERROR
+#define KIT_ERROR(...) _KIT_LOG_AND_BREAK(error, __VA_ARGS__)
+#define KIT_ASSERT_ERROR(cond, ...) _KIT_ASSERT(ERROR, cond, __VA_ARGS__)
+#define KIT_ERROR_EVERY_N(n, ...) _KIT_EVERY_N(ERROR, n, __VA_ARGS__)
+#define KIT_ERROR_EVERY_MS(ms, ...) _KIT_EVERY_MS(ERROR, ms, __VA_ARGS__)
+#else
+#define KIT_ERROR(...)
 #define KIT_ASSERT_ERROR(cond, ...)
+#define KIT_ERROR_EVERY_N(n, ...)
+#define KIT_ERROR_EVERY_MS(ms, ...)
+#endif
+
+#if KIT_ACTIVE_LOG_LEVEL <= KIT_LOG_LEVEL_CRITICAL
+#define KIT_CRITICAL(...) _KIT_LOG_AND_BREAK(critical, __VA_ARGS__)
+#define KIT_ASSERT_CRITICAL(cond, ...) _KIT_ASSERT(CRITICAL, cond, __VA_ARGS__)
+#define KIT_CRITICAL_EVERY_N(n, ...) _KIT_EVERY_N(CRITICAL, n, __VA_ARGS__)
+#define KIT_CRITICAL_EVERY_MS(ms, ...) _KIT_EVERY_MS(CRITICAL, ms, __VA_ARGS__)
+#else
+#define KIT_CRITICAL(...)
 #define KIT_ASSERT_CRITICAL(cond, ...)
+#define KIT_CRITICAL_EVERY_N(n, ...)
+#define KIT_CRITICAL_EVERY_MS(ms, ...)
+#endif
+
+#if defined(KIT_LOG) && defined(KIT_USE_SPDLOG)
+// the expression is evaluated even if the level is compiled out
+#define KIT_CHECK_RETURN_VALUE(expression, expected, level, ...)                                                       \
+    if (!(expression == expected))                                                                                     \
+    {                                                                                                                  \
+        KIT_##level(__VA_ARGS__)                                                                                       \
+    }
+#else
+#define KIT_SET_LEVEL(lvl)
+#define KIT_SET_PATTERN(patt)
+
+#define KIT_FATAL(...)
 #define KIT_ASSERT_FATAL(cond, ...)
 
 #define KIT_CHECK_RETURN_VALUE(expression, expected, level, ...) expression;
@@ -1,31 +1,207 @@
 #pragma once
 
 #include "kit/interface/identifiable.hpp"
+#include "kit/debug/log.hpp"
 
+#include <type_traits>
 #include <functional>
+#include <memory>
+#include <atomic>
+#include <array>
 
 namespace kit
 {
+// arguments are passed along by reference: lvalue references are kept as they are, everything else becomes a const
+// reference, so that the same arguments can be handed to several callbacks without copies
+template <typename T>
+using callback_arg = std::conditional_t<std::is_lvalue_reference_v<T>, T, const std::remove_reference_t<T> &>;
+
+// type erased callable that stores small functors (function pointers, lambdas capturing a few pointers) inline, and
+// only falls back to the heap for bigger ones. ids come from a per type counter, so creating a callback is cheap.
+// copies keep the id of the original, which is what events use to find them
 template <typename... Args> class callback : public identifiable<>
 {
   public:
-    using fun = std::function<void(Args...)>;
-    callback(const fun &fn = nullptr) : identifiable(kit::uuid::random()), m_fun(fn)
+    static inline constexpr std::size_t INLINE_SIZE = 3 * sizeof(void *);
+
+    callback(std::nullptr_t = nullptr) : identifiable(next_id())
+    {
+    }
+
+    template <typename F>
+        requires(!std::is_same_v<std::decay_t<F>, callback> &&
+                 std::is_invocable_v<std::decay_t<F> &, callback_arg<Args>...>)
+    callback(F &&fn) : identifiable(next_id())
+    {
+        store(std::forward<F>(fn));
+    }
+
+    callback(const callback &other) : identifiable(other.m_id)
+    {
+        copy_from(other);
+    }
+    callback(callback &&other) noexcept : identifiable(other.m_id)
+    {
+        move_from(other);
+    }
+
+    ~callback()
     {
+        reset();
     }
 
-    void operator()(Args... args) const
+    callback &operator=(const callback &other)
+    {
+        if (this != &other)
+        {
+            reset();
+            m_id = other.m_id;
+            copy_from(other);
+        }
+        return *this;
+    }
+    callback &operator=(callback &&other) noexcept
     {
-        KIT_ASSERT_ERROR(m_fun, "The callback must not be null")
-        m_fun(args...);
+        if (this != &other)
+        {
+            reset();
+            m_id = other.m_id;
+            move_from(other);
+        }
+        return *this;
     }
 
-    operator bool()
+    void operator()(callback_arg<Args>... args) const
     {
-        return m_fun != nullptr;
+        KIT_ASSERT_ERROR(m_invoke, "The callback must not be null")
+        m_invoke(m_storage.data(), args...);
+    }
+
+    // releases the stored functor. the id is kept
+    void reset()
+    {
+        if (m_manage)
+            m_manage(operation::DESTROY, m_storage.data(), nullptr);
+        m_invoke = nullptr;
+        m_manage = nullptr;
+    }
+
+    operator bool() const
+    {
+        return m_invoke != nullptr;
     }
 
   private:
-    fun m_fun;
+    enum class operation
+    {
+        COPY,
+        MOVE,
+        DESTROY
+    };
+
+    using invoker = void (*)(std::byte *, callback_arg<Args>...);
+    using manager = void (*)(operation, std::byte *, std::byte *);
+
+    alignas(std::max_align_t) mutable std::array<std::byte, INLINE_SIZE> m_storage;
+    invoker m_invoke = nullptr;
+
+    // null for trivially copyable functors, which are copied and moved byte by byte and need no destruction
+    manager m_manage = nullptr;
+
+    static inline std::atomic<std::uint64_t> s_next_id{1};
+
+    static uuid next_id()
+    {
+        return uuid(s_next_id.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    template <typename F>
+    static inline constexpr bool STORED_INLINE = sizeof(F) <= INLINE_SIZE &&
+                                                 alignof(F) <= alignof(std::max_align_t) &&
+                                                 std::is_nothrow_move_constructible_v<F>;
+
+    template <typename F> void store(F &&fn)
+    {
+        using functor = std::decay_t<F>;
+        // null function pointers and empty std::functions leave the callback null
+        if constexpr (std::is_pointer_v<functor> || std::is_member_pointer_v<functor> ||
+                      requires { fn.target_type(); })
+            if (!fn)
+                return;
+
+        if constexpr (STORED_INLINE<functor>)
+        {
+            std::construct_at(reinterpret_cast<functor *>(m_storage.data()), std::forward<F>(fn));
+            m_invoke = [](std::byte *storage, callback_arg<Args>... args) {
+                std::invoke(*reinterpret_cast<functor *>(storage), args...);
+            };
+            if constexpr (!std::is_trivially_copyable_v<functor>)
+                m_manage = &manage_inline<functor>;
+        }
+        else
+        {
+            *reinterpret_cast<functor **>(m_storage.data()) = new functor(std::forward<F>(fn));
+            m_invoke = [](std::byte *storage, callback_arg<Args>... args) {
+                std::invoke(**reinterpret_cast<functor **>(storage), args...);
+            };
+            m_manage = &manage_heap<functor>;
+        }
+    }
+
+    template <typename F> static void manage_inline(const operation op, std::byte *storage, std::byte *other)
+    {
+        F *fn = reinterpret_cast<F *>(storage);
+        switch (op)
+        {
+        case operation::COPY:
+            std::construct_at(reinterpret_cast<F *>(other), *fn);
+            break;
+        case operation::MOVE:
+            std::construct_at(reinterpret_cast<F *>(other), std::move(*fn));
+            std::destroy_at(fn);
+            break;
+        case operation::DESTROY:
+            std::destroy_at(fn);
+            break;
+        }
+    }
+    template <typename F> static void manage_heap(const operation op, std::byte *storage, std::byte *other)
+    {
+        F *&fn = *reinterpret_cast<F **>(storage);
+        switch (op)
+        {
+        case operation::COPY:
+            *reinterpret_cast<F **>(other) = new F(*fn);
+            break;
+        case operation::MOVE:
+            *reinterpret_cast<F **>(other) = fn;
+            fn = nullptr;
+            break;
+        case operation::DESTROY:
+            delete fn;
+            break;
+        }
+    }
+
+    void copy_from(const callback &other)
+    {
+        if (other.m_manage)
+            other.m_manage(operation::COPY, other.m_storage.data(), m_storage.data());
+        else
+            m_storage = other.m_storage;
+        m_invoke = other.m_invoke;
+        m_manage = other.m_manage;
+    }
+    void move_from(callback &other)
+    {
+        if (other.m_manage)
+            other.m_manage(operation::MOVE, other.m_storage.data(), m_storage.data());
+        else
+            m_storage = other.m_storage;
+        m_invoke = other.m_invoke;
+        m_manage = other.m_manage;
+        other.m_invoke = nullptr;
+        other.m_manage = nullptr;
+    }
 };
 } // namespace kit
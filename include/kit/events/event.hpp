@@ -1,79 +1,303 @@
 #pragma once
 
 #include "kit/debug/log.hpp"
+#include "kit/interface/non_copyable.hpp"
 #include "kit/events/callback.hpp"
+#include "kit/container/tracked_vector.hpp"
+#include "kit/multithreading/thread_pool.hpp"
 #include <vector>
+#include <tuple>
+#include <memory>
+#include <algorithm>
+#include <future>
+#include <exception>
 
 namespace kit
 {
+enum class dispatch_policy
+{
+    AWAIT, // returns once every subscriber has been called
+    DETACH // returns right away. the arguments and the callbacks are copied for the pool tasks
+};
+
+// main thread subscribers are always called from the dispatching thread
+enum class callback_affinity
+{
+    ANY_THREAD,
+    MAIN_THREAD
+};
+
+// callbacks are stored contiguously and found by id, which doubles as the subscription handle, so unsubscribing is a
+// swap-remove. the order in which callbacks are called is unspecified. callbacks may subscribe or unsubscribe (even
+// themselves) while the event is being dispatched: removed callbacks are not called again, and added ones are only
+// taken into account from the next dispatch on
 template <class... Args> class event
 {
   public:
-    event &operator+=(const callback<Args...> &cb)
+    using callback_type = callback<Args...>;
+    using handle = typename callback_type::id_type;
+
+    // the affinity only matters when dispatching on a thread pool. copies of a callback share its id, so subscribing a
+    // callback that is already subscribed does nothing and returns the existing handle
+    handle subscribe(callback_type cb, const callback_affinity affinity = callback_affinity::ANY_THREAD)
     {
-        m_callbacks.push_back(cb);
-        return *this;
+        const handle h = cb.id();
+        if (contains(h))
+        {
+            KIT_WARN("The callback is already subscribed")
+            return h;
+        }
+        if (m_depth > 0)
+            m_pending.emplace_back(std::move(cb), affinity);
+        else
+            m_subscriptions.emplace_back(std::move(cb), affinity);
+        return h;
+    }
+    template <typename F>
+        requires(!std::is_same_v<std::decay_t<F>, callback_type> && std::is_constructible_v<callback_type, F &&>)
+    handle subscribe(F &&fn, const callback_affinity affinity = callback_affinity::ANY_THREAD)
+    {
+        return subscribe(callback_type(std::forward<F>(fn)), affinity);
     }
-    event &operator-=(const callback<Args...> &cb)
+
+    // returns false if the handle was not subscribed. a callback removed during a dispatch stays inactive until the
+    // dispatch ends, and may have been subscribed again in the meantime, so the pending ones are checked as well
+    bool unsubscribe(const handle &h)
     {
-        for (auto it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
-            if (*it == cb)
+        const std::size_t index = m_subscriptions.find_index(h);
+        if (index != SIZE_MAX && m_subscriptions[index].active)
+        {
+            subscription &sub = m_subscriptions[index];
+            if (m_depth == 0)
+                m_subscriptions.erase_unordered(m_subscriptions.begin() + index);
+            else
             {
-                m_callbacks.erase(it);
-                return *this;
+                sub.active = false;
+                m_removals++;
             }
-        KIT_WARN("Callback was not found!")
+            return true;
+        }
+        for (auto it = m_pending.begin(); it != m_pending.end(); ++it)
+            if (it->id() == h)
+            {
+                m_pending.erase(it);
+                return true;
+            }
+        return false;
+    }
+
+    bool contains(const handle &h) const
+    {
+        const std::size_t index = m_subscriptions.find_index(h);
+        if (index != SIZE_MAX && m_subscriptions[index].active)
+            return true;
+        for (const subscription &sub : m_pending)
+            if (sub.id() == h)
+                return true;
+        return false;
+    }
+
+    event &operator+=(const callback_type &cb)
+    {
+        subscribe(cb);
+        return *this;
+    }
+    event &operator+=(callback_type &&cb)
+    {
+        subscribe(std::move(cb));
+        return *this;
+    }
+    // lambdas and other callables are wrapped into a callback. use subscribe instead to get a handle to remove it later
+    template <typename F>
+        requires(!std::is_same_v<std::decay_t<F>, callback_type> && std::is_constructible_v<callback_type, F &&>)
+    event &operator+=(F &&fn)
+    {
+        subscribe(callback_type(std::forward<F>(fn)));
         return *this;
     }
 
-    event &operator+=(const std::function<void(Args...)> &fn)
+    event &operator-=(const callback_type &cb)
     {
-        return *this += callback<Args...>(fn);
+        return *this -= cb.id();
     }
-    event &operator-=(const std::function<void(Args...)> &fn)
+    event &operator-=(const handle &h)
     {
-        return *this -= callback<Args...>(fn);
+        if (!unsubscribe(h))
+        {
+            KIT_WARN("Callback was not found!")
+        }
+        return *this;
     }
 
-    void operator()(Args... args) const
+    void operator()(callback_arg<Args>... args)
     {
-        for (std::size_t i = m_callbacks.size() - 1; i < m_callbacks.size(); i--)
-            m_callbacks[i](args...);
+        const dispatch_scope scope(*this);
+        const std::size_t size = m_subscriptions.size();
+        for (std::size_t i = 0; i < size; i++)
+            if (m_subscriptions[i].active)
+                m_subscriptions[i].cb(args...);
     }
 
-    const callback<Args...> &operator[](const std::size_t index)
+    // subscribers that may run on any thread are split into one workload per pool thread, while main thread subscribers
+    // are called from this thread in the meantime. with the await policy, the workloads are taken from the subscribers
+    // that were active when the dispatch started, so a subscriber removed halfway through may still be called once, and
+    // if a subscriber throws, the first exception is rethrown once every workload is done. the detach policy requires
+    // copyable arguments. pool subscribers must not subscribe or unsubscribe from this event
+    template <dispatch_policy Policy = dispatch_policy::AWAIT>
+        requires(Policy == dispatch_policy::AWAIT || (std::is_copy_constructible_v<std::remove_cvref_t<Args>> && ...))
+    void dispatch(mt::thread_pool &pool, callback_arg<Args>... args)
     {
-        KIT_ASSERT_ERROR(index < m_callbacks.size(), "Index exceeds container size: {0}", index)
-        return m_callbacks[index];
+        if constexpr (Policy == dispatch_policy::DETACH)
+            dispatch_detached(pool, args...);
+        else
+            dispatch_awaited(pool, args...);
     }
+
     std::size_t size() const
     {
-        return m_callbacks.size();
+        return m_subscriptions.size() - m_removals + m_pending.size();
     }
     bool empty() const
     {
-        return m_callbacks.empty();
+        return size() == 0;
     }
 
-    auto begin() const
+    void clear()
     {
-        return m_callbacks.begin();
+        KIT_ASSERT_ERROR(m_depth == 0, "Cannot clear an event while it is being dispatched")
+        m_subscriptions.clear();
+        m_pending.clear();
+        m_removals = 0;
     }
-    auto end() const
+
+  private:
+    struct subscription : identifiable<>
     {
-        return m_callbacks.end();
+        subscription(callback_type &&fn, const callback_affinity aff)
+            : identifiable(fn.id()), cb(std::move(fn)), affinity(aff)
+        {
+        }
+
+        callback_type cb;
+        callback_affinity affinity;
+        bool active = true;
+    };
+
+    // keeps track of nested dispatches. the changes made during a dispatch are applied when the outermost one ends,
+    // even if a callback throws
+    struct dispatch_scope : non_copyable
+    {
+        dispatch_scope(event &ev) : ev(ev)
+        {
+            ev.m_depth++;
+        }
+        ~dispatch_scope()
+        {
+            if (--ev.m_depth == 0 && (ev.m_removals > 0 || !ev.m_pending.empty()))
+                ev.flush();
+        }
+
+        event &ev;
+    };
+
+    tracked_vector<subscription> m_subscriptions;
+    std::vector<subscription> m_pending;
+    std::size_t m_removals = 0;
+    std::uint32_t m_depth = 0;
+
+    // applies the changes made during a dispatch. going backwards, every swapped in element has already been checked
+    void flush()
+    {
+        for (std::size_t i = m_subscriptions.size() - 1; i < m_subscriptions.size() && m_removals > 0; i--)
+            if (!m_subscriptions[i].active)
+            {
+                m_subscriptions.erase_unordered(m_subscriptions.begin() + i);
+                m_removals--;
+            }
+        for (subscription &sub : m_pending)
+            m_subscriptions.emplace_back(std::move(sub));
+        m_pending.clear();
     }
 
-    auto begin()
+    void call_main_thread_subscribers(callback_arg<Args>... args)
     {
-        return m_callbacks.begin();
+        const std::size_t size = m_subscriptions.size();
+        for (std::size_t i = 0; i < size; i++)
+            if (m_subscriptions[i].active && m_subscriptions[i].affinity == callback_affinity::MAIN_THREAD)
+                m_subscriptions[i].cb(args...);
     }
-    auto end()
+
+    // the indices are local to each dispatch, as a main thread subscriber may dispatch this event again. the tasks
+    // refer to them and to the arguments, so every task is waited for before leaving, even when something throws
+    void dispatch_awaited(mt::thread_pool &pool, callback_arg<Args>... args)
     {
-        return m_callbacks.end();
+        const dispatch_scope scope(*this);
+        std::vector<std::size_t> parallel;
+        for (std::size_t i = 0; i < m_subscriptions.size(); i++)
+            if (m_subscriptions[i].active && m_subscriptions[i].affinity == callback_affinity::ANY_THREAD)
+                parallel.push_back(i);
+
+        const std::size_t size = parallel.size();
+        const std::size_t workloads = std::min(size, pool.thread_count());
+        std::vector<std::future<void>> futures;
+        futures.reserve(workloads);
+
+        std::exception_ptr error;
+        try
+        {
+            for (std::size_t i = 0; i < workloads; i++)
+            {
+                const std::size_t start = i * size / workloads;
+                const std::size_t end = (i + 1) * size / workloads;
+                futures.push_back(pool.submit([this, &parallel, start, end, &args...]() {
+                    for (std::size_t j = start; j < end; j++)
+                        m_subscriptions[parallel[j]].cb(args...);
+                }));
+            }
+            call_main_thread_subscribers(args...);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        for (std::future<void> &future : futures)
+            try
+            {
+                future.get();
+            }
+            catch (...)
+            {
+                if (!error)
+                    error = std::current_exception();
+            }
+        if (error)
+            std::rethrow_exception(error);
     }
 
-  private:
-    std::vector<callback<Args...>> m_callbacks;
+    // the pool tasks share a copy of the callbacks and the arguments, so they can outlive both this call and the event
+    void dispatch_detached(mt::thread_pool &pool, callback_arg<Args>... args)
+    {
+        auto callbacks = std::make_shared<std::vector<callback_type>>();
+        for (const subscription &sub : m_subscriptions)
+            if (sub.active && sub.affinity == callback_affinity::ANY_THREAD)
+                callbacks->push_back(sub.cb);
+        auto payload = std::make_shared<std::tuple<std::remove_cvref_t<Args>...>>(args...);
+
+        const std::size_t size = callbacks->size();
+        const std::size_t workloads = std::min(size, pool.thread_count());
+        for (std::size_t i = 0; i < workloads; i++)
+        {
+            const std::size_t start = i * size / workloads;
+            const std::size_t end = (i + 1) * size / workloads;
+            pool.submit([callbacks, payload, start, end]() {
+                for (std::size_t j = start; j < end; j++)
+                    std::apply([&cb = (*callbacks)[j]](auto &...pargs) { cb(pargs...); }, *payload);
+            });
+        }
+
+        const dispatch_scope scope(*this);
+        call_main_thread_subscribers(args...);
+    }
 };
 } // namespace kit
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "kit/debug/log.hpp"
+#include "kit/events/event.hpp"
+#include "kit/memory/ptr/scope.hpp"
+#include "kit/interface/non_copyable.hpp"
+#include <atomic>
+#include <vector>
+#include <span>
+#include <iterator>
+
+namespace kit
+{
+class _event_channel_base
+{
+  public:
+    virtual ~_event_channel_base() = default;
+
+    virtual void dispatch() = 0;
+    virtual void clear() = 0;
+    virtual std::size_t pending() const = 0;
+};
+
+// each producer buffer sits on its own cache line, so that producers enqueueing at the same time do not keep taking
+// the line away from each other when their vectors grow
+template <typename T> struct alignas(64) _producer_buffer
+{
+    std::vector<T> events;
+};
+
+template <typename T> class _event_channel final : public _event_channel_base
+{
+  public:
+    _event_channel(const std::size_t producers) : producer_buffers(producers)
+    {
+    }
+
+    std::vector<T> buffer;
+    std::vector<_producer_buffer<T>> producer_buffers;
+    event<std::span<const T>> on_batch;
+
+    // the batch is moved out before dispatching, so that subscribers can enqueue new events of the same type. those
+    // are left for the next dispatch, unless a subscriber dispatches the queue again: each dispatch owns its batch, so
+    // a nested one only delivers the events enqueued since the outer one started
+    void dispatch() override
+    {
+        std::vector<T> batch;
+        batch.swap(buffer);
+        for (_producer_buffer<T> &pbuffer : producer_buffers)
+        {
+            batch.insert(batch.end(), std::make_move_iterator(pbuffer.events.begin()),
+                         std::make_move_iterator(pbuffer.events.end()));
+            pbuffer.events.clear();
+        }
+        if (!batch.empty())
+            on_batch(std::span<const T>(batch));
+
+        // the storage is handed back if nothing was enqueued meanwhile, so that it is reused
+        if (buffer.empty())
+        {
+            batch.clear();
+            buffer.swap(batch);
+        }
+    }
+
+    void clear() override
+    {
+        buffer.clear();
+        for (_producer_buffer<T> &pbuffer : producer_buffers)
+            pbuffer.events.clear();
+    }
+
+    std::size_t pending() const override
+    {
+        std::size_t count = buffer.size();
+        for (const _producer_buffer<T> &pbuffer : producer_buffers)
+            count += pbuffer.events.size();
+        return count;
+    }
+};
+
+// defers events until dispatch is called. each event type gets its own channel with a contiguous buffer, and each
+// subscriber receives the whole batch of a channel at once, so it runs as a single tight loop instead of being
+// interleaved with whatever code emitted the events. subscribers may take either a span of events or a single event
+// (they are then looped over the batch). channels are dispatched in the order their types were first used by any queue.
+// for multi producer setups (mt::for_each workers, for example), the queue is created with a producer count and each
+// producer enqueues into its own buffer with emplace_from, without locking. producers must only ever touch their own
+// index, the channel must already exist (see open), and nothing else may be done with the queue in the meantime
+class event_queue : non_copyable
+{
+  public:
+    using handle = typename callback<>::id_type;
+
+    event_queue(const std::size_t producers = 0) : m_producers(producers)
+    {
+    }
+
+    template <typename T, typename F> handle subscribe(F &&fn)
+    {
+        if constexpr (std::is_invocable_v<std::decay_t<F> &, std::span<const T>>)
+            return channel<T>().on_batch.subscribe(std::forward<F>(fn));
+        else
+            return channel<T>().on_batch.subscribe([fn = std::forward<F>(fn)](const std::span<const T> batch) mutable {
+                for (const T &ev : batch)
+                    fn(ev);
+            });
+    }
+    template <typename T> bool unsubscribe(const handle &h)
+    {
+        _event_channel<T> *ch = existing_channel<T>();
+        return ch && ch->on_batch.unsubscribe(h);
+    }
+
+    // creates the channel of the given type if it does not exist yet
+    template <typename T> void open()
+    {
+        channel<T>();
+    }
+
+    template <typename T, class... Args> void emplace(Args &&...args)
+    {
+        channel<T>().buffer.emplace_back(std::forward<Args>(args)...);
+    }
+    template <typename T> void push(T &&ev)
+    {
+        emplace<std::decay_t<T>>(std::forward<T>(ev));
+    }
+
+    template <typename T, class... Args> void emplace_from(const std::size_t producer, Args &&...args)
+    {
+        KIT_ASSERT_ERROR(producer < m_producers, "Producer index exceeds the producer count: {0}", producer)
+        _event_channel<T> *ch = existing_channel<T>();
+        KIT_ASSERT_ERROR(ch, "The channel must be opened before producers can enqueue events concurrently")
+        ch->producer_buffers[producer].events.emplace_back(std::forward<Args>(args)...);
+    }
+
+    template <typename T> void dispatch()
+    {
+        if (_event_channel<T> *ch = existing_channel<T>())
+            ch->dispatch();
+    }
+    // channels may be created while dispatching, so they are accessed by index every time
+    void dispatch()
+    {
+        for (std::size_t i = 0; i < m_channels.size(); i++)
+            if (m_channels[i])
+                m_channels[i]->dispatch();
+    }
+
+    template <typename T> std::size_t pending() const
+    {
+        const _event_channel<T> *ch = existing_channel<T>();
+        return ch ? ch->pending() : 0;
+    }
+    std::size_t pending() const
+    {
+        std::size_t count = 0;
+        for (const scope<_event_channel_base> &ch : m_channels)
+            if (ch)
+                count += ch->pending();
+        return count;
+    }
+
+    // drops every pending event. subscribers are kept
+    void clear()
+    {
+        for (const scope<_event_channel_base> &ch : m_channels)
+            if (ch)
+                ch->clear();
+    }
+
+    std::size_t producers() const
+    {
+        return m_producers;
+    }
+
+  private:
+    std::vector<scope<_event_channel_base>> m_channels;
+    std::size_t m_producers;
+
+    static inline std::atomic<std::size_t> s_channel_count{0};
+
+    // every event type gets a process wide index, so channels are found without hashing
+    template <typename T> static std::size_t channel_index()
+    {
+        static const std::size_t index = s_channel_count.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    template <typename T> _event_channel<T> &channel()
+    {
+        const std::size_t index = channel_index<T>();
+        if (index >= m_channels.size())
+            m_channels.resize(index + 1);
+        if (!m_channels[index])
+            m_channels[index] = make_scope<_event_channel<T>>(m_producers);
+        return static_cast<_event_channel<T> &>(*m_channels[index]);
+    }
+
+    template <typename T> _event_channel<T> *existing_channel() const
+    {
+        const std::size_t index = channel_index<T>();
+        return index < m_channels.size() ? static_cast<_event_channel<T> *>(m_channels[index].get()) : nullptr;
+    }
+};
+} // namespace kit
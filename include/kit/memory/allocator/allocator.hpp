@@ -3,6 +3,7 @@
 #include "kit/debug/log.hpp"
 #include "kit/interface/non_copyable.hpp"
 #include <cstdlib>
+#include <utility>
 
 namespace kit
 {
@@ -92,6 +93,13 @@ template <typename T> class continuous_allocator : public discrete_allocator<T>
         return nallocate(1);
     }
 
+    // grows or shrinks the allocation at ptr to count elements without moving it, if the allocator is able to. returns
+    // false otherwise, in which case the allocation is left untouched
+    virtual bool resize_in_place(T *, std::size_t)
+    {
+        return false;
+    }
+
     template <class... Args> T *ncreate(const std::size_t count, Args &&...args)
     {
         T *ptr = nallocate(count);
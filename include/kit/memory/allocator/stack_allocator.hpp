@@ -32,6 +32,20 @@ template <typename T = void, std::size_t Capacity = 0> class stack_allocator fin
         m_entries.pop_back();
     }
 
+    // only the last allocated object can be resized
+    bool resize_in_place(T *ptr, const std::size_t count) override
+    {
+        if (count == 0 || m_entries.empty() || !can_deallocate(ptr))
+            return false;
+        const std::size_t base = m_memory.size() - m_entries.back().size;
+        const std::size_t size = count * sizeof(T);
+        if (Capacity * sizeof(T) - base < size)
+            return false;
+        m_memory.resize(base + size);
+        m_entries.back().size = size;
+        return true;
+    }
+
     bool owns(const T *ptr) const override
     {
         const std::byte *byte_ptr = (const std::byte *)ptr;
@@ -87,13 +101,27 @@ template <typename T> class stack_allocator<T, 0> final : public continuous_allo
         if (m_current_stack_count == 0)
         {
             m_current_stack--;
-            m_current_stack_count = m_entries.back().stack_count;
+            m_current_stack_count = m_entries.back().stack_count - m_entries.back().alloc_count;
         }
         else
             m_current_stack_count -= m_entries.back().alloc_count;
         m_entries.pop_back();
     }
 
+    // only the last allocated object can be resized, and only within its stack
+    bool resize_in_place(T *ptr, const std::size_t count) override
+    {
+        if (count == 0 || m_entries.empty() || m_current_stack_count == 0 || !can_deallocate(ptr))
+            return false;
+        const std::size_t base = m_current_stack_count - m_entries.back().alloc_count;
+        if (m_stack_obj_count - base < count)
+            return false;
+        m_current_stack_count = base + count;
+        m_entries.back().alloc_count = count;
+        m_entries.back().stack_count = m_current_stack_count;
+        return true;
+    }
+
     bool owns(const T *ptr) const override
     {
         for (T *stack : m_stacks)
@@ -267,7 +295,7 @@ template <> class stack_allocator<void, 0> final : public allocator
         if (m_current_stack_size == 0)
         {
             m_current_stack--;
-            m_current_stack_size = m_entries.back().stack_size;
+            m_current_stack_size = m_entries.back().stack_size - m_entries.back().alloc_size;
         }
         else
             m_current_stack_size -= m_entries.back().alloc_size;
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "kit/memory/ptr/track_ptr.hpp"
+#include "kit/container/slot_map.hpp"
+
+namespace kit
+{
+template <typename T> using slot_ptr = track_ptr<slot_map<T>>;
+template <typename T> using const_slot_ptr = track_ptr<const slot_map<T>>;
+} // namespace kit
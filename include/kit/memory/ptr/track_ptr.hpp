@@ -19,12 +19,37 @@ concept IDContainer = requires(Container a) {
     } -> std::convertible_to<const typename Container::value_type &>;
 };
 
+// containers that hand out their own stable handles, such as slot_map. elements are reached through get(handle), which
+// must return a null pointer for stale handles
+template <typename Container>
+concept HandleContainer = requires(Container a, const typename Container::handle h) {
+    typename Container::value_type;
+    requires Hashable<typename Container::handle>;
+    {
+        a.get(h)
+    } -> std::convertible_to<const typename Container::value_type *>;
+};
+
+// id containers that can tell where an element with a given id is, returning SIZE_MAX if it is not present. track_ptr
+// uses this instead of searching when its cached index becomes stale
+template <typename Container>
+concept IndexedIDContainer =
+    IDContainer<Container> && requires(Container a, const typename Container::value_type::id_type &id) {
+        {
+            a.find_index(id)
+        } -> std::convertible_to<std::size_t>;
+    };
+
 template <typename From, typename To>
 concept ConstConvertibleContainer =
-    IDContainer<From> && IDContainer<To> && std::is_same_v<std::remove_const_t<From>, std::remove_const_t<To>> &&
-    !(std::is_const_v<From> && !std::is_const_v<To>);
+    std::is_same_v<std::remove_const_t<From>, std::remove_const_t<To>> && !(std::is_const_v<From> && !std::is_const_v<To>);
 
-template <IDContainer Container> class track_ptr : public identifiable<typename Container::value_type::id_type>
+template <typename Container> class track_ptr;
+
+// tracks an element of a container by id. the cached index is checked first, but if the container was mutated, the
+// element has to be searched for again
+template <IDContainer Container>
+class track_ptr<Container> : public identifiable<typename Container::value_type::id_type>
 {
     using T = typename Container::value_type;
     using ID = typename T::id_type;
@@ -39,7 +64,7 @@ template <IDContainer Container> class track_ptr : public identifiable<typename
 
     track_ptr() = default;
     track_ptr(Container *container, const std::size_t index = 0)
-        : identifiable<ID>(container ? (*container)[index].id : ID()), m_container(container), m_index(index)
+        : identifiable<ID>(container ? (*container)[index].id() : ID()), m_container(container), m_index(index)
     {
         KIT_ASSERT_ERROR(!m_container || m_index < m_container->size(),
                          "A track ptr cannot have an index greater or equal to the container size!");
@@ -47,16 +72,18 @@ template <IDContainer Container> class track_ptr : public identifiable<typename
 
     template <typename OtherContainer>
         requires ConstConvertibleContainer<OtherContainer, Container>
-    track_ptr(const track_ptr<OtherContainer> &other) : m_container(other.m_container), m_index(other.m_index)
+    track_ptr(const track_ptr<OtherContainer> &other)
+        : identifiable<ID>(other.id()), m_container(other.m_container), m_index(other.m_index)
     {
-        this->id = other.id;
     }
 
-    template <typename OtherContainer> track_ptr &operator=(const track_ptr<OtherContainer> &other)
+    template <typename OtherContainer>
+        requires ConstConvertibleContainer<OtherContainer, Container>
+    track_ptr &operator=(const track_ptr<OtherContainer> &other)
     {
         m_container = other.m_container;
         m_index = other.m_index;
-        this->id = other.id;
+        this->m_id = other.id();
         return *this;
     }
 
@@ -64,16 +91,23 @@ template <IDContainer Container> class track_ptr : public identifiable<typename
     {
         if (!m_container || m_index == SIZE_MAX)
             return validity::NOT_VALID;
-        if (m_index < m_container->size() && (*m_container)[m_index].id == this->id)
+        if (m_index < m_container->size() && (*m_container)[m_index].id() == this->m_id)
             return validity::VALID;
-        if (m_index > 0 && (*m_container)[m_index - 1].id == this->id) // More likely to be shifted
+        if constexpr (IndexedIDContainer<Container>)
+        {
+            m_index = m_container->find_index(this->m_id);
+            return m_index == SIZE_MAX ? validity::NOT_VALID : validity::VALID_MUTATED;
+        }
+
+        if (m_index > 0 && m_index <= m_container->size() &&
+            (*m_container)[m_index - 1].id() == this->m_id) // More likely to be shifted
         {
             m_index--;
             return validity::VALID_MUTATED;
         }
 
         for (std::size_t i = 0; i < m_container->size(); i++)
-            if ((*m_container)[i].id == this->id)
+            if ((*m_container)[i].id() == this->m_id)
             {
                 m_index = i;
                 return validity::VALID_MUTATED;
@@ -102,27 +136,90 @@ template <IDContainer Container> class track_ptr : public identifiable<typename
         return (*m_container)[m_index];
     }
 
+  private:
+    Container *m_container = nullptr;
+    mutable std::size_t m_index;
+
+    template <typename OtherContainer> friend class track_ptr;
+};
+
+// the container already validates its handles, so there is nothing to search for: the pointer is either valid or not
+template <HandleContainer Container> class track_ptr<Container>
+{
+    using handle = typename Container::handle;
+
+  public:
+    enum class validity
+    {
+        VALID,
+        NOT_VALID,
+        VALID_MUTATED
+    };
+
+    track_ptr() = default;
+    track_ptr(Container *container, const handle h) : m_container(container), m_handle(h)
+    {
+    }
+
+    template <typename OtherContainer>
+        requires ConstConvertibleContainer<OtherContainer, Container>
+    track_ptr(const track_ptr<OtherContainer> &other) : m_container(other.m_container), m_handle(other.m_handle)
+    {
+    }
+
     template <typename OtherContainer>
-    operator track_ptr<OtherContainer>()
-        requires ConstConvertibleContainer<Container, OtherContainer>
+        requires ConstConvertibleContainer<OtherContainer, Container>
+    track_ptr &operator=(const track_ptr<OtherContainer> &other)
+    {
+        m_container = other.m_container;
+        m_handle = other.m_handle;
+        return *this;
+    }
+
+    validity validate() const
+    {
+        return raw() ? validity::VALID : validity::NOT_VALID;
+    }
+
+    operator bool() const
+    {
+        return raw() != nullptr;
+    }
+
+    const handle &id() const
+    {
+        return m_handle;
+    }
+
+    auto *raw() const
+    {
+        return m_container ? m_container->get(m_handle) : nullptr;
+    }
+    auto *operator->() const
     {
-        track_ptr<OtherContainer> ptr{m_container, m_index};
-        ptr.id = this->id;
+        auto *ptr = raw();
+        KIT_ASSERT_ERROR(ptr, "Cannot dereference a null or stale pointer")
         return ptr;
     }
+    auto &operator*() const
+    {
+        auto *ptr = raw();
+        KIT_ASSERT_ERROR(ptr, "Cannot dereference a null or stale pointer")
+        return *ptr;
+    }
 
   private:
     Container *m_container = nullptr;
-    mutable std::size_t m_index;
+    handle m_handle{};
 
-    template <IDContainer OtherContainer> friend class track_ptr;
+    template <typename OtherContainer> friend class track_ptr;
 };
 } // namespace kit
 
-template <kit::IDContainer Container> struct std::hash<kit::track_ptr<Container>>
+template <typename Container> struct std::hash<kit::track_ptr<Container>>
 {
     std::size_t operator()(const kit::track_ptr<Container> &ptr) const
     {
-        return std::hash<kit::uuid>()(ptr.id);
+        return std::hash<std::remove_cvref_t<decltype(ptr.id())>>()(ptr.id());
     }
 };
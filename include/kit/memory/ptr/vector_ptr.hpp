@@ -1,8 +1,15 @@
-#include "kit/memory/track_ptr.hpp"
+#pragma once
+
+#include "kit/memory/ptr/track_ptr.hpp"
+#include "kit/container/tracked_vector.hpp"
 #include <vector>
 
 namespace kit
 {
 template <typename T, class... Args> using vector_ptr = track_ptr<std::vector<T, Args...>>;
 template <typename T, class... Args> using const_vector_ptr = track_ptr<const std::vector<T, Args...>>;
-} // namespace kit
\ No newline at end of file
+
+// revalidation after a mutation is O(1) instead of a linear search
+template <typename T> using tracked_vector_ptr = track_ptr<tracked_vector<T>>;
+template <typename T> using const_tracked_vector_ptr = track_ptr<const tracked_vector<T>>;
+} // namespace kit
@@ -21,7 +21,7 @@ template <> struct feach_return<void>
 
 template <typename It, typename F, class... Args> struct type_helper
 {
-    using fun_ret_t = std::invoke_result_t<F, typename It::value_type, Args...>;
+    using fun_ret_t = std::invoke_result_t<F, std::iter_reference_t<It>, Args...>;
 
     // doing this bc shitty msvc wont discard the right fucking if constexpr branch
     static void worker_impl(It it1, It it2, F &&fun, std::true_type, Args &&...args)
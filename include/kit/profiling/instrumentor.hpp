@@ -1,6 +1,7 @@
 #pragma once
 
 #include "kit/profiling/clock.hpp"
+#include "kit/container/flat_hash_map.hpp"
 #include <stack>
 #include <sstream>
 
@@ -55,7 +56,7 @@ class instrumentor
     struct measurement_registry
     {
         std::vector<measurement> flat;
-        std::unordered_map<const char *, std::size_t> map;
+        flat_hash_map<const char *, std::size_t> map;
     };
 
     std::stack<ongoing_measurement> m_ongoing_measurements{};
@@ -0,0 +1,410 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <string>
+#include <string_view>
+#include <span>
+#include <utility>
+#include <bit>
+#include <cstring>
+#include <cstdint>
+#include <concepts>
+#include <type_traits>
+#include <algorithm>
+
+namespace kit::bin
+{
+template <typename T> struct codec;
+
+class writer;
+class reader;
+
+class encodeable
+{
+  public:
+    virtual ~encodeable() = default;
+    virtual void encode(writer &out) const = 0;
+};
+
+class decodeable
+{
+  public:
+    virtual ~decodeable() = default;
+    virtual bool decode(reader &in) = 0;
+};
+
+class codecable : public encodeable, public decodeable
+{
+};
+
+template <typename T>
+concept Encodeable = std::is_base_of_v<encodeable, T> || requires(writer &out, const T &instance) {
+    codec<T>::encode(out, instance);
+};
+
+template <typename T>
+concept Decodeable = std::is_base_of_v<decodeable, T> || requires(reader &in, T &instance) {
+    {
+        codec<T>::decode(in, instance)
+    } -> std::convertible_to<bool>;
+};
+
+template <typename T>
+concept Codecable = Encodeable<T> && Decodeable<T>;
+
+// values that are written as is (in little endian order). long double is left out, as its layout is not portable
+template <typename T>
+concept Scalar = (std::is_arithmetic_v<T> || std::is_enum_v<T>) && !std::is_same_v<std::remove_cv_t<T>, long double>;
+
+template <Scalar T> constexpr T _to_little_endian(const T value)
+{
+    if constexpr (std::endian::native == std::endian::little || sizeof(T) == 1)
+        return value;
+    else
+    {
+        auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+        for (std::size_t i = 0; i < sizeof(T) / 2; i++)
+            std::swap(bytes[i], bytes[sizeof(T) - i - 1]);
+        return std::bit_cast<T>(bytes);
+    }
+}
+
+// appends the binary representation of values to a byte buffer. scalars are stored in little endian order, and
+// strings and containers are prefixed with their length as a 64 bit integer. the version is whatever the caller wants
+// it to be: codecs may check it to decide what to write, and it is stored in the header by serialize
+class writer
+{
+  public:
+    writer(const std::uint32_t version = 0) : m_version(version)
+    {
+    }
+
+    template <typename T> void write(const T &instance)
+    {
+        if constexpr (std::is_base_of_v<encodeable, T>)
+            instance.encode(*this);
+        else
+            codec<T>::encode(*this, instance);
+    }
+
+    template <Scalar T> void write_scalar(const T value)
+    {
+        const T little = _to_little_endian(value);
+        write_bytes(std::as_bytes(std::span<const T, 1>(&little, 1)));
+    }
+    // contiguous scalars are copied in one go when the byte order allows it
+    template <Scalar T> void write_scalars(const std::span<const T> values)
+    {
+        if constexpr (std::endian::native == std::endian::little)
+            write_bytes(std::as_bytes(values));
+        else
+            for (const T value : values)
+                write_scalar(value);
+    }
+
+    void write_size(const std::size_t size)
+    {
+        write_scalar(static_cast<std::uint64_t>(size));
+    }
+    void write_bytes(const std::span<const std::byte> bytes)
+    {
+        const std::size_t offset = m_bytes.size();
+        m_bytes.resize(offset + bytes.size());
+        if (!bytes.empty())
+            std::memcpy(m_bytes.data() + offset, bytes.data(), bytes.size());
+    }
+
+    void reserve(const std::size_t bytes)
+    {
+        m_bytes.reserve(bytes);
+    }
+
+    const std::vector<std::byte> &bytes() const
+    {
+        return m_bytes;
+    }
+    std::vector<std::byte> release()
+    {
+        return std::move(m_bytes);
+    }
+
+    std::uint32_t version() const
+    {
+        return m_version;
+    }
+
+  private:
+    std::vector<std::byte> m_bytes;
+    std::uint32_t m_version;
+};
+
+// reads values back from a byte buffer, which must outlive the reader. every read is bounds checked: once a read
+// fails, the reader is left in a failed state and every following read fails as well, so codecs may chain reads and
+// check the result once. lengths are checked against the remaining bytes, and containers of elements with no fixed
+// size grow as their elements are decoded, so corrupt data cannot trigger huge allocations
+class reader
+{
+  public:
+    reader(const std::span<const std::byte> bytes, const std::uint32_t version = 0)
+        : m_bytes(bytes), m_version(version)
+    {
+    }
+
+    template <typename T> bool read(T &instance)
+    {
+        if (m_failed)
+            return false;
+        bool success;
+        if constexpr (std::is_base_of_v<decodeable, T>)
+            success = instance.decode(*this);
+        else
+            success = codec<T>::decode(*this, instance);
+        if (!success)
+            m_failed = true;
+        return success;
+    }
+    template <typename T>
+        requires std::is_default_constructible_v<T>
+    T read()
+    {
+        T instance{};
+        read(instance);
+        return instance;
+    }
+
+    template <Scalar T> bool read_scalar(T &value)
+    {
+        std::array<std::byte, sizeof(T)> bytes;
+        if (!read_bytes(bytes))
+            return false;
+        value = _to_little_endian(std::bit_cast<T>(bytes));
+        return true;
+    }
+    bool read_scalar(bool &value)
+    {
+        std::uint8_t byte;
+        if (!read_scalar(byte))
+            return false;
+        value = byte != 0;
+        return true;
+    }
+    template <Scalar T> bool read_scalars(const std::span<T> values)
+    {
+        if constexpr (std::endian::native == std::endian::little && !std::is_same_v<T, bool>)
+            return read_bytes(std::as_writable_bytes(values));
+        else
+        {
+            for (T &value : values)
+                if (!read_scalar(value))
+                    return false;
+            return true;
+        }
+    }
+
+    // element_size is the amount of bytes each of the counted elements takes at the very least
+    bool read_size(std::size_t &size, const std::size_t element_size = 1)
+    {
+        std::uint64_t value;
+        if (!read_scalar(value))
+            return false;
+        if (value > remaining() / element_size)
+            return fail();
+        size = static_cast<std::size_t>(value);
+        return true;
+    }
+    bool read_bytes(const std::span<std::byte> bytes)
+    {
+        if (m_failed || bytes.size() > remaining())
+            return fail();
+        if (!bytes.empty())
+            std::memcpy(bytes.data(), m_bytes.data() + m_position, bytes.size());
+        m_position += bytes.size();
+        return true;
+    }
+
+    std::size_t remaining() const
+    {
+        return m_bytes.size() - m_position;
+    }
+    std::size_t position() const
+    {
+        return m_position;
+    }
+    bool failed() const
+    {
+        return m_failed;
+    }
+
+    std::uint32_t version() const
+    {
+        return m_version;
+    }
+    void version(const std::uint32_t version)
+    {
+        m_version = version;
+    }
+
+  private:
+    std::span<const std::byte> m_bytes;
+    std::size_t m_position = 0;
+    std::uint32_t m_version;
+    bool m_failed = false;
+
+    bool fail()
+    {
+        m_failed = true;
+        return false;
+    }
+};
+
+template <Scalar T> struct codec<T>
+{
+    static void encode(writer &out, const T value)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+            out.write_scalar(static_cast<std::uint8_t>(value));
+        else
+            out.write_scalar(value);
+    }
+    static bool decode(reader &in, T &value)
+    {
+        return in.read_scalar(value);
+    }
+};
+
+template <typename Char, typename Traits, typename Alloc> struct codec<std::basic_string<Char, Traits, Alloc>>
+{
+    static void encode(writer &out, const std::basic_string<Char, Traits, Alloc> &str)
+    {
+        out.write_size(str.size());
+        out.write_scalars(std::span<const Char>(str));
+    }
+    static bool decode(reader &in, std::basic_string<Char, Traits, Alloc> &str)
+    {
+        std::size_t size;
+        if (!in.read_size(size, sizeof(Char)))
+            return false;
+        str.resize(size);
+        return in.read_scalars(std::span<Char>(str));
+    }
+};
+
+template <typename T, typename Alloc> struct codec<std::vector<T, Alloc>>
+{
+    static void encode(writer &out, const std::vector<T, Alloc> &vec)
+    {
+        out.write_size(vec.size());
+        if constexpr (Scalar<T> && !std::is_same_v<T, bool>)
+            out.write_scalars(std::span<const T>(vec));
+        else
+            for (const T &element : vec)
+                out.write(element);
+    }
+    // scalars have a known size, so their count is checked up front. other elements may take any amount of bytes, so
+    // the vector grows as they are decoded instead
+    static bool decode(reader &in, std::vector<T, Alloc> &vec)
+    {
+        std::size_t size;
+        if constexpr (Scalar<T> && !std::is_same_v<T, bool>)
+        {
+            if (!in.read_size(size, sizeof(T)))
+                return false;
+            vec.resize(size);
+            return in.read_scalars(std::span<T>(vec));
+        }
+        else
+        {
+            if (!in.read_size(size))
+                return false;
+            vec.clear();
+            vec.reserve(std::min(size, in.remaining() / sizeof(T)));
+            for (std::size_t i = 0; i < size; i++)
+            {
+                T element{};
+                if (!in.read(element))
+                    return false;
+                vec.push_back(std::move(element));
+            }
+            return true;
+        }
+    }
+};
+
+// the size is part of the type, so it is not stored
+template <typename T, std::size_t N> struct codec<std::array<T, N>>
+{
+    static void encode(writer &out, const std::array<T, N> &arr)
+    {
+        if constexpr (Scalar<T> && !std::is_same_v<T, bool>)
+            out.write_scalars(std::span<const T>(arr));
+        else
+            for (const T &element : arr)
+                out.write(element);
+    }
+    static bool decode(reader &in, std::array<T, N> &arr)
+    {
+        if constexpr (Scalar<T> && !std::is_same_v<T, bool>)
+            return in.read_scalars(std::span<T>(arr));
+        else
+        {
+            for (T &element : arr)
+                if (!in.read(element))
+                    return false;
+            return true;
+        }
+    }
+};
+
+template <typename T1, typename T2> struct codec<std::pair<T1, T2>>
+{
+    static void encode(writer &out, const std::pair<T1, T2> &pair)
+    {
+        out.write(pair.first);
+        out.write(pair.second);
+    }
+    static bool decode(reader &in, std::pair<T1, T2> &pair)
+    {
+        return in.read(pair.first) && in.read(pair.second);
+    }
+};
+
+// std::map, std::unordered_map and the like
+template <typename T>
+concept _MapLike = requires(T map, typename T::key_type key, typename T::mapped_type value) {
+    typename T::key_type;
+    typename T::mapped_type;
+    map.clear();
+    map.size();
+    map.emplace(std::move(key), std::move(value));
+};
+
+template <_MapLike T> struct codec<T>
+{
+    static void encode(writer &out, const T &map)
+    {
+        out.write_size(map.size());
+        for (const auto &[key, value] : map)
+        {
+            out.write(key);
+            out.write(value);
+        }
+    }
+    static bool decode(reader &in, T &map)
+    {
+        std::size_t size;
+        if (!in.read_size(size))
+            return false;
+        map.clear();
+        for (std::size_t i = 0; i < size; i++)
+        {
+            typename T::key_type key{};
+            typename T::mapped_type value{};
+            if (!in.read(key) || !in.read(value))
+                return false;
+            map.emplace(std::move(key), std::move(value));
+        }
+        return true;
+    }
+};
+} // namespace kit::bin
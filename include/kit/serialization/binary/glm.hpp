@@ -0,0 +1,50 @@
+#pragma once
+
+#include "kit/serialization/binary/codec.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#define GLM_FORCE_INTRINSICS
+#include <glm/glm.hpp>
+#include <glm/gtx/norm.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/rotate_vector.hpp>
+
+// components are written one by one, as the memory layout of glm types may include padding depending on the
+// qualifier and the intrinsics in use
+template <glm::length_t L, kit::bin::Scalar T, glm::qualifier Q> struct kit::bin::codec<glm::vec<L, T, Q>>
+{
+    static void encode(writer &out, const glm::vec<L, T, Q> &v)
+    {
+        for (glm::length_t i = 0; i < L; i++)
+            out.write_scalar(v[i]);
+    }
+
+    static bool decode(reader &in, glm::vec<L, T, Q> &v)
+    {
+        for (glm::length_t i = 0; i < L; i++)
+            if (!in.read_scalar(v[i]))
+                return false;
+        return true;
+    }
+};
+
+// column major, as glm stores them
+template <glm::length_t C, glm::length_t R, kit::bin::Scalar T, glm::qualifier Q>
+struct kit::bin::codec<glm::mat<C, R, T, Q>>
+{
+    static void encode(writer &out, const glm::mat<C, R, T, Q> &m)
+    {
+        for (glm::length_t i = 0; i < C; i++)
+            out.write(m[i]);
+    }
+
+    static bool decode(reader &in, glm::mat<C, R, T, Q> &m)
+    {
+        for (glm::length_t i = 0; i < C; i++)
+            if (!in.read(m[i]))
+                return false;
+        return true;
+    }
+};
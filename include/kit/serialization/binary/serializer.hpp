@@ -0,0 +1,91 @@
+#pragma once
+
+#include "kit/serialization/binary/codec.hpp"
+#include "kit/debug/log.hpp"
+#include <string>
+#include <fstream>
+
+namespace kit::bin
+{
+// every serialized buffer starts with a header: the magic bytes, the version of the layout described in codec.hpp and
+// the version chosen by the caller, which codecs can read back through reader::version
+inline constexpr std::array<std::byte, 4> MAGIC{std::byte{'K'}, std::byte{'I'}, std::byte{'T'}, std::byte{'B'}};
+inline constexpr std::uint32_t FORMAT_VERSION = 1;
+
+template <typename T> std::vector<std::byte> to_bytes(const T &instance, const std::uint32_t version = 0)
+{
+    writer out(version);
+    out.write_bytes(MAGIC);
+    out.write_scalar(FORMAT_VERSION);
+    out.write_scalar(version);
+    out.write(instance);
+    return out.release();
+}
+
+template <typename T> bool from_bytes(T &instance, const std::span<const std::byte> bytes)
+{
+    reader in(bytes);
+    std::array<std::byte, 4> magic;
+    std::uint32_t format;
+    std::uint32_t version;
+    if (!in.read_bytes(magic) || magic != MAGIC || !in.read_scalar(format) || !in.read_scalar(version))
+    {
+        KIT_ERROR("Failed to deserialize. The data is not a binary kit buffer")
+        return false;
+    }
+    if (format > FORMAT_VERSION)
+    {
+        KIT_ERROR("Failed to deserialize. Unsupported binary format version: {0}", format)
+        return false;
+    }
+    in.version(version);
+    KIT_CHECK_RETURN_VALUE(in.read(instance), true, ERROR, "Failed to deserialize. Attempted to decode wrong data?")
+    return !in.failed();
+}
+
+template <typename T> void serialize(const T &instance, const std::string &path, const std::uint32_t version = 0)
+{
+    const std::vector<std::byte> bytes = to_bytes(instance, version);
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+template <typename T> bool deserialize(T &instance, const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+    {
+        KIT_ERROR("Failed to deserialize. Could not open file: {0}", path)
+        return false;
+    }
+    std::vector<std::byte> bytes(static_cast<std::size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return from_bytes(instance, bytes);
+}
+
+template <typename T> T deserialize(const std::string &path)
+{
+    T instance;
+    deserialize(instance, path);
+    return instance;
+}
+
+class serializable : public encodeable
+{
+  public:
+    void serialize(const std::string &path, const std::uint32_t version = 0) const
+    {
+        kit::bin::serialize(*this, path, version);
+    }
+};
+
+class deserializable : public decodeable
+{
+  public:
+    bool deserialize(const std::string &path)
+    {
+        return kit::bin::deserialize(*this, path);
+    }
+};
+} // namespace kit::bin
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "kit/serialization/binary/codec.hpp"
+#include "kit/serialization/binary/glm.hpp"
+#include "kit/utility/transform.hpp"
+
+// the parent is not serialized, as it is a pointer to an arbitrary transform
+template <std::floating_point Float> struct kit::bin::codec<kit::transform2D<Float>>
+{
+    static void encode(writer &out, const kit::transform2D<Float> &transform)
+    {
+        out.write(transform.position);
+        out.write(transform.scale);
+        out.write(transform.origin);
+        out.write(transform.rotation);
+    }
+
+    static bool decode(reader &in, kit::transform2D<Float> &transform)
+    {
+        return in.read(transform.position) && in.read(transform.scale) && in.read(transform.origin) &&
+               in.read(transform.rotation);
+    }
+};
+
+template <std::floating_point Float> struct kit::bin::codec<kit::transform3D<Float>>
+{
+    static void encode(writer &out, const kit::transform3D<Float> &transform)
+    {
+        out.write(transform.position);
+        out.write(transform.scale);
+        out.write(transform.origin);
+        out.write(transform.rotation);
+    }
+
+    static bool decode(reader &in, kit::transform3D<Float> &transform)
+    {
+        return in.read(transform.position) && in.read(transform.scale) && in.read(transform.origin) &&
+               in.read(transform.rotation);
+    }
+};
@@ -39,6 +39,7 @@ template <typename T> T deserialize(const std::string &path)
 {
     T instance;
     deserialize(instance, path);
+    return instance;
 }
 #endif
 class serializable : public encodeable
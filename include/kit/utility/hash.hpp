@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace kit
+{
+// 64 bit finalizer in the style of the wyhash/xxh3 avalanche steps (moremur constants): every input bit affects every
+// output bit. std::hash is the identity for integers in most standard libraries, so raw ids and handles should go
+// through this before being used to pick a bucket
+constexpr std::uint64_t hash_mix(std::uint64_t x)
+{
+    x ^= x >> 27;
+    x *= 0x3C79AC492BA7B653ull;
+    x ^= x >> 33;
+    x *= 0x1C69B3F74AC4AE35ull;
+    x ^= x >> 27;
+    return x;
+}
+
+// order dependent: combining a then b differs from combining b then a
+constexpr std::uint64_t hash_combine(const std::uint64_t seed, const std::uint64_t value)
+{
+    return hash_mix(seed + 0x9E3779B97F4A7C15ull + value);
+}
+
+// order independent: each value is mixed on its own and the results are summed, so permutations hash to the same value
+// but unrelated sets do not collide by construction. the accumulated sum should be finalized with hash_mix
+constexpr std::uint64_t hash_accumulate(const std::uint64_t sum, const std::uint64_t value)
+{
+    return sum + hash_mix(value + 0x9E3779B97F4A7C15ull);
+}
+} // namespace kit
@@ -0,0 +1,8 @@
+#pragma once
+
+// sse2 is guaranteed on every x86-64 target, so this is only disabled on other architectures or very old x86 builds.
+// every user of KIT_SSE2 must provide a scalar fallback
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KIT_SSE2
+#include <emmintrin.h>
+#endif
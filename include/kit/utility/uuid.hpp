@@ -1,11 +1,22 @@
 #pragma once
 
+#include "kit/utility/hash.hpp"
 #include <cstdint>
 #include <functional>
 #include <string>
 
 namespace kit
 {
+// random ids come from a thread local xoshiro256** generator. sequential ids need no generator at all: the high 16
+// bits are a tag owned by the thread and the low 48 bits are a per tag counter. tags of exited threads are reused and
+// keep counting from where they were left, so sequential ids are unique within a process run as long as no more than
+// 65536 threads generate them at the same time. past that, an error is reported and random ids are returned instead
+enum class uuid_generation
+{
+    RANDOM,
+    SEQUENTIAL
+};
+
 class uuid
 {
   public:
@@ -15,9 +26,17 @@ class uuid
     operator std::uint64_t() const;
 
     static uuid random();
-    static const std::string &name_from_id(uuid id, std::uint32_t min_characters = 3, std::uint32_t max_characters = 8);
-    static const std::string &name_from_ptr(const void *ptr, std::uint32_t min_characters = 3,
-                                            std::uint32_t max_characters = 8);
+    static uuid sequential();
+
+    // uses the current generation policy, which is random by default
+    static uuid generate();
+    static uuid_generation generation_policy();
+    static void generation_policy(uuid_generation policy);
+    // names are deterministic, pronounceable-ish strings. names of up to 15 characters fit in the small string buffer
+    // of common standard libraries, so they are returned by value without allocating
+    static std::string name_from_id(uuid id, std::uint32_t min_characters = 3, std::uint32_t max_characters = 8);
+    static std::string name_from_ptr(const void *ptr, std::uint32_t min_characters = 3,
+                                     std::uint32_t max_characters = 8);
 
   private:
     std::uint64_t m_uuid;
@@ -30,5 +49,8 @@ bool operator!=(const uuid &id1, const uuid &id2);
 
 template <> struct std::hash<kit::uuid>
 {
-    std::size_t operator()(const kit::uuid &id) const;
+    std::size_t operator()(const kit::uuid &id) const
+    {
+        return (std::size_t)kit::hash_mix((std::uint64_t)id);
+    }
 };
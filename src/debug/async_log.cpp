@@ -0,0 +1,233 @@
+#include "kit/internal/pch.hpp"
+#include "kit/debug/async_log.hpp"
+
+#ifdef KIT_USE_SPDLOG
+#include <bit>
+
+namespace kit
+{
+_log_ring::_log_ring(const std::size_t capacity) : m_records(capacity), m_mask(capacity - 1)
+{
+}
+
+_log_record *_log_ring::try_claim()
+{
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_tail.load(std::memory_order_acquire) == m_records.size())
+        return nullptr;
+    return &m_records[head & m_mask];
+}
+void _log_ring::commit()
+{
+    m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+_log_record *_log_ring::front()
+{
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail == m_head.load(std::memory_order_acquire))
+        return nullptr;
+    return &m_records[tail & m_mask];
+}
+void _log_ring::pop()
+{
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool _log_ring::empty() const
+{
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+}
+std::size_t _log_ring::committed() const
+{
+    return m_head.load(std::memory_order_acquire);
+}
+std::size_t _log_ring::written() const
+{
+    return m_tail.load(std::memory_order_acquire);
+}
+
+// the default logger is taken before the background thread starts. this also makes sure the spdlog registry is
+// constructed before (and so destroyed after) this logger
+async_logger::async_logger() : m_logger(spdlog::default_logger()), m_thread(&async_logger::run, this)
+{
+}
+
+async_logger::~async_logger()
+{
+    shutdown();
+}
+
+async_logger &async_logger::main()
+{
+    static async_logger logger;
+    return logger;
+}
+
+void async_logger::configure(const async_log_settings &settings)
+{
+    KIT_ASSERT_ERROR(settings.ring_capacity > 0, "Ring capacity must be greater than zero")
+    m_ring_capacity.store(std::bit_ceil(settings.ring_capacity), std::memory_order_relaxed);
+    m_overflow_policy.store(settings.overflow_policy, std::memory_order_relaxed);
+}
+
+// waits for each ring to be written up to where it was when the flush started
+void async_logger::flush()
+{
+    std::vector<std::pair<std::shared_ptr<_log_ring>, std::size_t>> targets;
+    {
+        std::scoped_lock<std::mutex> lock{m_rings_mutex};
+        targets.reserve(m_rings.size());
+        for (const auto &ring : m_rings)
+            if (!ring->empty())
+                targets.emplace_back(ring, ring->committed());
+    }
+
+    while (!targets.empty() && m_running.load(std::memory_order_acquire))
+    {
+        std::erase_if(targets, [](const auto &target) { return target.first->written() >= target.second; });
+        if (targets.empty())
+            break;
+        wake();
+        std::this_thread::yield();
+    }
+    m_logger->flush();
+}
+
+void async_logger::shutdown()
+{
+    {
+        std::scoped_lock<std::mutex> lock{m_wake_mutex};
+        if (!m_running.load(std::memory_order_relaxed))
+            return;
+        m_running.store(false, std::memory_order_release);
+    }
+    m_wake.notify_one();
+    m_thread.join();
+    m_logger->flush();
+}
+
+std::size_t async_logger::dropped() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+// the ring is owned by the logger. when the thread exits, the ring is only marked as closed, so that whatever it still
+// holds gets written before the background thread removes it
+struct _log_ring_holder
+{
+    _log_ring *ring = nullptr;
+    ~_log_ring_holder()
+    {
+        if (ring)
+            ring->closed.store(true, std::memory_order_release);
+    }
+};
+
+_log_ring &async_logger::thread_ring()
+{
+    thread_local _log_ring_holder holder;
+    if (!holder.ring)
+    {
+        auto ring = std::make_shared<_log_ring>(m_ring_capacity.load(std::memory_order_relaxed));
+        holder.ring = ring.get();
+
+        std::scoped_lock<std::mutex> lock{m_rings_mutex};
+        m_rings.push_back(std::move(ring));
+    }
+    return *holder.ring;
+}
+
+_log_record *async_logger::claim()
+{
+    _log_ring &ring = thread_ring();
+    for (;;)
+    {
+        if (_log_record *record = ring.try_claim())
+            return record;
+        if (m_overflow_policy.load(std::memory_order_relaxed) == log_overflow_policy::DROP)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        // nothing will make room once the background thread is gone. the caller writes the message itself
+        if (!m_running.load(std::memory_order_acquire))
+            return nullptr;
+        wake();
+        std::this_thread::yield();
+    }
+}
+
+// the fences pair a producer committing a record and then checking the flag with the background thread clearing the
+// flag and then checking the rings: at least one of them sees the other's write, so a record is never left behind
+// while the background thread sleeps. the mutex is only taken by the producer that raises the flag
+void async_logger::wake()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_signaled.load(std::memory_order_relaxed) || m_signaled.exchange(true, std::memory_order_relaxed))
+        return;
+    {
+        std::scoped_lock<std::mutex> lock{m_wake_mutex};
+    }
+    m_wake.notify_one();
+}
+
+void async_logger::run()
+{
+    fmt::memory_buffer buffer;
+    while (m_running.load(std::memory_order_acquire))
+    {
+        m_signaled.store(false, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (drain(buffer))
+            continue;
+
+        std::unique_lock<std::mutex> lock{m_wake_mutex};
+        m_wake.wait(lock, [this]() {
+            return m_signaled.load(std::memory_order_relaxed) || !m_running.load(std::memory_order_relaxed);
+        });
+    }
+    while (drain(buffer))
+        ;
+}
+
+// the rings are written without holding the lock, so that threads logging for the first time are not held up by a
+// slow sink. only this thread removes rings, so the copy stays valid. each ring is written up to where it was when the
+// pass started: a thread logging faster than the sink can write cannot keep the pass going forever
+bool async_logger::drain(fmt::memory_buffer &buffer)
+{
+    spdlog::logger *logger = m_logger.get();
+    bool written = false;
+
+    {
+        std::scoped_lock<std::mutex> lock{m_rings_mutex};
+        m_draining.assign(m_rings.begin(), m_rings.end());
+    }
+    for (const auto &ring : m_draining)
+        for (std::size_t count = ring->committed() - ring->written(); count > 0; count--)
+        {
+            _log_record *record = ring->front();
+            buffer.clear();
+            try
+            {
+                record->consume(*record, buffer);
+                logger->log(record->level, spdlog::string_view_t(buffer.data(), buffer.size()));
+            }
+            catch (const std::exception &e)
+            {
+                logger->error("Failed to format an asynchronous log message: {0}", e.what());
+            }
+            ring->pop();
+            written = true;
+        }
+    m_draining.clear();
+
+    // a ring can only be removed once its thread has exited and everything it logged has been written
+    std::scoped_lock<std::mutex> lock{m_rings_mutex};
+    std::erase_if(m_rings, [](const std::shared_ptr<_log_ring> &ring) {
+        return ring->closed.load(std::memory_order_acquire) && ring->empty();
+    });
+    return written;
+}
+} // namespace kit
+#endif
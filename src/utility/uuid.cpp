@@ -1,11 +1,63 @@
 #include "kit/internal/pch.hpp"
 #include "kit/utility/uuid.hpp"
+#include <atomic>
+#include <bit>
+#include <mutex>
+#include <vector>
 
 namespace kit
 {
-static thread_local std::random_device s_device;
-static thread_local std::mt19937_64 s_eng(s_device());
-static thread_local std::uniform_int_distribution<uint64_t> s_dist;
+static std::uint64_t splitmix64(std::uint64_t &state)
+{
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+namespace
+{
+// 32 bytes of state. each thread seeds its own generator by running splitmix64 over a process wide seed, drawn once,
+// mixed with the order in which threads first ask for an id
+class xoshiro256ss
+{
+  public:
+    xoshiro256ss(std::uint64_t seed)
+    {
+        for (std::uint64_t &s : m_state)
+            s = splitmix64(seed);
+    }
+
+    std::uint64_t operator()()
+    {
+        const std::uint64_t result = std::rotl(m_state[1] * 5, 7) * 9;
+        const std::uint64_t t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = std::rotl(m_state[3], 45);
+        return result;
+    }
+
+  private:
+    std::uint64_t m_state[4];
+};
+} // namespace
+
+static std::atomic<std::uint64_t> s_random_threads{0};
+static std::atomic<uuid_generation> s_policy{uuid_generation::RANDOM};
+
+static std::uint64_t process_seed()
+{
+    static const std::uint64_t seed = [] {
+        std::random_device device;
+        const std::uint64_t entropy = ((std::uint64_t)device() << 32) | device();
+        return entropy ^ (std::uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+    }();
+    return seed;
+}
 
 uuid::uuid(const std::uint64_t uuid) : m_uuid(uuid)
 {
@@ -13,7 +65,100 @@ uuid::uuid(const std::uint64_t uuid) : m_uuid(uuid)
 
 uuid uuid::random()
 {
-    return uuid(s_dist(s_eng));
+    thread_local xoshiro256ss generator(process_seed() ^ hash_mix(s_random_threads.fetch_add(1) + 1));
+    return uuid(generator());
+}
+
+namespace
+{
+struct sequential_tag
+{
+    static inline constexpr std::uint64_t COUNT = 1ull << 16;
+    static inline constexpr std::uint64_t MAX_COUNTER = (1ull << 48) - 1;
+
+    std::uint64_t tag;
+    std::uint64_t counter;
+};
+
+struct sequential_tag_pool
+{
+    std::mutex mutex;
+    std::vector<sequential_tag> released;
+    std::uint64_t next = 0;
+};
+
+sequential_tag_pool &tag_pool()
+{
+    static sequential_tag_pool pool;
+    return pool;
+}
+
+// takes a thread tag the first time a thread asks for a sequential id, and gives it back when the thread exits along
+// with its counter, so that the next thread to take it carries on from there instead of repeating ids
+class sequential_generator
+{
+  public:
+    sequential_generator()
+    {
+        sequential_tag_pool &pool = tag_pool();
+        std::scoped_lock<std::mutex> lock(pool.mutex);
+        if (!pool.released.empty())
+        {
+            m_tag = pool.released.back();
+            pool.released.pop_back();
+            m_valid = true;
+        }
+        else if (pool.next < sequential_tag::COUNT)
+        {
+            m_tag = {pool.next++, 0};
+            m_valid = true;
+        }
+    }
+    ~sequential_generator()
+    {
+        if (!m_valid)
+            return;
+        sequential_tag_pool &pool = tag_pool();
+        std::scoped_lock<std::mutex> lock(pool.mutex);
+        pool.released.push_back(m_tag);
+    }
+
+    bool next(std::uint64_t &id)
+    {
+        if (!m_valid || m_tag.counter == sequential_tag::MAX_COUNTER)
+            return false;
+        id = (m_tag.tag << 48) | ++m_tag.counter;
+        return true;
+    }
+
+  private:
+    sequential_tag m_tag{0, 0};
+    bool m_valid = false;
+};
+} // namespace
+
+uuid uuid::sequential()
+{
+    thread_local sequential_generator generator;
+    std::uint64_t id;
+    if (generator.next(id))
+        return uuid(id);
+    KIT_ERROR("Ran out of sequential ids for this thread. Falling back to random ids")
+    return random();
+}
+
+uuid uuid::generate()
+{
+    return s_policy.load(std::memory_order_relaxed) == uuid_generation::RANDOM ? random() : sequential();
+}
+
+uuid_generation uuid::generation_policy()
+{
+    return s_policy.load(std::memory_order_relaxed);
+}
+void uuid::generation_policy(const uuid_generation policy)
+{
+    s_policy.store(policy, std::memory_order_relaxed);
 }
 
 uuid::operator uint64_t() const
@@ -30,52 +175,78 @@ bool operator!=(const uuid &id1, const uuid &id2)
     return (std::uint64_t)id1 != (std::uint64_t)id2;
 }
 
-static bool in_between(const std::uint32_t x, const std::uint32_t mm, const std::uint32_t mx)
+namespace
 {
-    return x <= mm && x <= mx;
+// names are cached per thread in a small direct mapped table: a new id simply evicts whatever was in its entry.
+// generating a name is cheap and deterministic, so an eviction only costs a regeneration
+struct name_entry
+{
+    static inline constexpr std::size_t CAPACITY = 15;
+
+    std::uint64_t id;
+    std::uint32_t min_characters = 0;
+    std::uint32_t max_characters = 0;
+    std::uint8_t size = 0;
+    std::array<char, CAPACITY> name;
+};
+} // namespace
+
+static void generate_name(const uuid id, const std::uint32_t min_characters, const std::uint32_t max_characters,
+                          std::string &name)
+{
+    static constexpr const char syllables[6] = "aieou";
+    static constexpr const char consonants[22] = "bcdfghjklmnpqrstvwxyz";
+
+    // the name only depends on the id, so the random stream is a splitmix64 sequence seeded with it
+    std::uint64_t state = (std::uint64_t)id;
+    const std::uint8_t is_pair = (std::uint8_t)(splitmix64(state) % 2);
+    while (name.size() < max_characters)
+    {
+        const bool is_syllable = name.size() % 2 == is_pair && splitmix64(state) % 12 < 11;
+        const std::size_t idx = (std::size_t)(splitmix64(state) % (is_syllable ? 5 : 21));
+        if (name.size() >= min_characters && (is_syllable ? (idx == 4) : (idx == 20)))
+            break;
+        name.push_back(is_syllable ? syllables[idx] : consonants[idx]);
+    }
+    if (!name.empty())
+        name[0] = (char)toupper(name[0]);
 }
 
-const std::string &uuid::name_from_ptr(const void *ptr, const std::uint32_t min_characters,
-                                       const std::uint32_t max_characters)
+std::string uuid::name_from_ptr(const void *ptr, const std::uint32_t min_characters, const std::uint32_t max_characters)
 {
     return name_from_id(uuid((std::uint64_t)ptr), min_characters, max_characters);
 }
 
-const std::string &uuid::name_from_id(const uuid id, const std::uint32_t min_characters,
-                                      const std::uint32_t max_characters)
+std::string uuid::name_from_id(const uuid id, const std::uint32_t min_characters, const std::uint32_t max_characters)
 {
     KIT_ASSERT_ERROR(min_characters <= max_characters,
                      "Maximum characters must be greater or equal than minimum characters")
 
-    thread_local static std::unordered_map<uuid, std::string> names;
-    const auto existing = names.find(id);
-    if (existing != names.end() && in_between((std::uint32_t)names.at(id).size(), min_characters, max_characters))
-        return existing->second;
-
-    srand((std::uint32_t)id);
-    static constexpr const char syllables[6] = "aieou";
-    static constexpr const char consonants[22] = "bcdfghjklmnpqrstvwxyz";
-
     std::string name;
     name.reserve(max_characters);
+    if (max_characters > name_entry::CAPACITY)
+    {
+        generate_name(id, min_characters, max_characters, name);
+        return name;
+    }
 
-    const std::uint8_t is_pair = (std::uint8_t)(rand() % 2);
-    while (name.size() < max_characters)
+    static constexpr std::size_t CACHE_SIZE = 256;
+    thread_local std::array<name_entry, CACHE_SIZE> cache{};
+
+    name_entry &entry = cache[hash_mix(id) & (CACHE_SIZE - 1)];
+    if (entry.max_characters != 0 && entry.id == (std::uint64_t)id && entry.min_characters == min_characters &&
+        entry.max_characters == max_characters)
     {
-        const bool is_syllable = name.size() % 2 == is_pair && rand() % 12 < 11;
-        const std::size_t idx = (std::size_t)(rand() % (is_syllable ? 5 : 21));
-        if (name.size() >= min_characters && (is_syllable ? (idx == 4) : (idx == 20)))
-            break;
-        name.push_back(is_syllable ? syllables[idx] : consonants[idx]);
+        name.assign(entry.name.data(), entry.size);
+        return name;
     }
 
-    name[0] = (char)toupper(name[0]);
-    names[id] = name;
-    return names.at(id);
+    generate_name(id, min_characters, max_characters, name);
+    entry.id = (std::uint64_t)id;
+    entry.min_characters = min_characters;
+    entry.max_characters = max_characters;
+    entry.size = (std::uint8_t)name.size();
+    std::copy(name.begin(), name.end(), entry.name.begin());
+    return name;
 }
 } // namespace kit
-
-std::size_t std::hash<kit::uuid>::operator()(const kit::uuid &key) const
-{
-    return std::hash<uint64_t>()((std::uint64_t)key);
-}
\ No newline at end of file